@@ -0,0 +1,492 @@
+// Сравнение Vector и std::vector на основных операциях. Помимо времени каждая серия
+// сообщает allocs/op - среднее число обращений к глобальному operator new на одну операцию.
+// Запуск: ./vector_benchmark --benchmark_filter=PushBack
+#include "bulk_ops.h"
+#include "sorting.h"
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+size_t allocation_count = 0;
+
+void* CountedAllocate(size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* CountedAllocate(size_t size, std::align_val_t alignment) {
+    ++allocation_count;
+    const auto align = static_cast<size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return CountedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+// Нетривиальный тип, перемещение которого может выбросить исключение:
+// при перевыделении памяти контейнеры вынуждены его копировать
+struct ThrowingMove {
+    ThrowingMove() = default;
+    explicit ThrowingMove(int value)
+        : text(std::to_string(value)) {
+    }
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : text(std::move(other.text)) {
+    }
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+    ThrowingMove& operator=(ThrowingMove&&) = default;
+
+    std::string text;
+};
+
+template <typename T>
+T MakeValue(int i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return std::string(32, static_cast<char>('a' + i % 26));
+    }
+    else {
+        return T(i);
+    }
+}
+
+// Единый интерфейс к обоим контейнерам
+template <typename T>
+void PushBack(Vector<T>& v, T value) {
+    v.PushBack(std::move(value));
+}
+
+template <typename T>
+void PushBack(std::vector<T>& v, T value) {
+    v.push_back(std::move(value));
+}
+
+template <typename T>
+size_t Size(const Vector<T>& v) {
+    return v.Size();
+}
+
+template <typename T>
+size_t Size(const std::vector<T>& v) {
+    return v.size();
+}
+
+template <typename T>
+void Insert(Vector<T>& v, size_t pos, T value) {
+    v.Insert(v.begin() + pos, std::move(value));
+}
+
+template <typename T>
+void Insert(std::vector<T>& v, size_t pos, T value) {
+    v.insert(v.begin() + pos, std::move(value));
+}
+
+template <typename T>
+void Erase(Vector<T>& v, size_t pos) {
+    v.Erase(v.begin() + pos);
+}
+
+template <typename T>
+void Erase(std::vector<T>& v, size_t pos) {
+    v.erase(v.begin() + pos);
+}
+
+template <typename T>
+void Resize(Vector<T>& v, size_t size) {
+    v.Resize(size);
+}
+
+template <typename T>
+void Resize(std::vector<T>& v, size_t size) {
+    v.resize(size);
+}
+
+template <typename T>
+void Reserve(Vector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void Reserve(std::vector<T>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename Container>
+Container MakeFilled(size_t size) {
+    using T = std::decay_t<decltype(*std::declval<Container&>().begin())>;
+    Container v;
+    for (size_t i = 0; i < size; ++i) {
+        PushBack(v, MakeValue<T>(static_cast<int>(i)));
+    }
+    return v;
+}
+
+// Выставляет среднее число выделений памяти на одну операцию, если за итерацию их выполнено ops
+void ReportAllocations(benchmark::State& state, size_t allocations_before, size_t ops) {
+    const double allocations = static_cast<double>(allocation_count - allocations_before);
+    state.counters["allocs/op"] = benchmark::Counter(allocations / static_cast<double>(ops),
+                                                     benchmark::Counter::kAvgIterations);
+}
+
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+    using T = std::decay_t<decltype(*std::declval<Container&>().begin())>;
+    const auto n = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    const size_t allocations_before = allocation_count;
+    for (auto _ : state) {
+        Container v;
+        for (size_t i = 0; i < n; ++i) {
+            PushBack(v, value);
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    ReportAllocations(state, allocations_before, n);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Вставка в позицию size * numerator / 4: 0 - в начало, 2 - в середину
+template <typename Container, size_t Numerator>
+void BM_Insert(benchmark::State& state) {
+    using T = std::decay_t<decltype(*std::declval<Container&>().begin())>;
+    const auto n = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container v = MakeFilled<Container>(n);
+        const size_t allocations_before = allocation_count;
+        state.ResumeTiming();
+        for (size_t i = 0; i < n; ++i) {
+            Insert(v, Size(v) * Numerator / 4, value);
+        }
+        benchmark::DoNotOptimize(v.begin());
+        allocations += allocation_count - allocations_before;
+    }
+    state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations) / static_cast<double>(n),
+                                                     benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+template <typename Container, size_t Numerator>
+void BM_Erase(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container v = MakeFilled<Container>(n * 2);
+        const size_t allocations_before = allocation_count;
+        state.ResumeTiming();
+        for (size_t i = 0; i < n; ++i) {
+            Erase(v, Size(v) * Numerator / 4);
+        }
+        benchmark::DoNotOptimize(v.begin());
+        allocations += allocation_count - allocations_before;
+    }
+    state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations) / static_cast<double>(n),
+                                                     benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Присваивание копированием в контейнер, вместимости которого достаточно
+template <typename Container>
+void BM_CopyAssignReuse(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const Container source = MakeFilled<Container>(n);
+    Container target = MakeFilled<Container>(n);
+    const size_t allocations_before = allocation_count;
+    for (auto _ : state) {
+        target = source;
+        benchmark::DoNotOptimize(target.begin());
+    }
+    ReportAllocations(state, allocations_before, 1);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(*source.begin())));
+}
+
+template <typename Container>
+void BM_Resize(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const size_t allocations_before = allocation_count;
+    for (auto _ : state) {
+        Container v;
+        Resize(v, n);
+        benchmark::DoNotOptimize(v.begin());
+        Resize(v, n / 2);
+        Resize(v, n);
+        benchmark::DoNotOptimize(v.begin());
+    }
+    ReportAllocations(state, allocations_before, 1);
+}
+
+// Перевыделение памяти заполненного контейнера
+template <typename Container>
+void BM_Reserve(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container v = MakeFilled<Container>(n);
+        const size_t allocations_before = allocation_count;
+        state.ResumeTiming();
+        Reserve(v, n * 2);
+        benchmark::DoNotOptimize(v.begin());
+        allocations += allocation_count - allocations_before;
+    }
+    state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations),
+                                                     benchmark::Counter::kAvgIterations);
+}
+
+// Массовые операции из bulk_ops.h против стандартных алгоритмов над тем же Vector
+template <typename T, bool UseBulk>
+void BM_Sum(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    Vector<T> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = static_cast<T>(i % 1000);
+    }
+    for (auto _ : state) {
+        if constexpr (UseBulk) {
+            benchmark::DoNotOptimize(bulk::Sum(v));
+        }
+        else {
+            benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), bulk::SumType<T>{}));
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(T)));
+}
+
+// Поиск отсутствующего значения просматривает весь массив
+template <typename T, bool UseBulk>
+void BM_Find(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    Vector<T> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = static_cast<T>(i % 100);
+    }
+    const T needle = static_cast<T>(-1);
+    for (auto _ : state) {
+        if constexpr (UseBulk) {
+            benchmark::DoNotOptimize(bulk::Find(v, needle));
+        }
+        else {
+            benchmark::DoNotOptimize(std::find(v.begin(), v.end(), needle));
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(T)));
+}
+
+// Узел размером в строку кэша. Узлы перемешаны в памяти, как после долгой работы
+// аллокатора, поэтому каждое обращение по указателю - промах кэша, если узлов много
+struct alignas(64) Node {
+    int64_t value = 0;
+};
+
+struct NodeList {
+    explicit NodeList(size_t size)
+        : nodes(size) {
+        for (size_t i = 0; i < size; ++i) {
+            nodes[i].value = static_cast<int64_t>(i);
+            pointers.PushBack(&nodes[i]);
+        }
+        std::shuffle(pointers.begin(), pointers.end(), std::mt19937(42));
+    }
+
+    Vector<Node> nodes;
+    Vector<Node*> pointers;
+};
+
+// Обработка узла - цепочка зависимых умножений. Чем она длиннее, тем меньше следующих
+// промахов кэша процессор успевает начать сам, не дожидаясь предвыборки
+inline int64_t Process(const Node& node) {
+    auto hash = static_cast<uint64_t>(node.value);
+    for (int i = 0; i < 8; ++i) {
+        hash = (hash ^ (hash >> 29)) * 0x9e3779b97f4a7c15;
+    }
+    return static_cast<int64_t>(hash);
+}
+
+// Обход Vector<Node*>: обычный цикл против ForEachPrefetched с расстоянием state.range(1).
+// Пока узлы помещаются в кэш, выигрыша почти нет; на узлах, не помещающихся в кэш,
+// предвыборка скрывает задержку памяти, если расстояние покрывает её
+template <bool UsePrefetch>
+void BM_PointerTraversal(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto distance = static_cast<size_t>(state.range(1));
+    const NodeList list(n);
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        if constexpr (UsePrefetch) {
+            list.pointers.ForEachPrefetched([&sum](const Node* node) {
+                sum += static_cast<uint64_t>(Process(*node));
+            }, distance);
+        }
+        else {
+            for (const Node* node : list.pointers) {
+                sum += static_cast<uint64_t>(Process(*node));
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Два прохода по данным - масштабирование и извлечение корня. Обычный код делает их по всему
+// массиву и дважды читает его из памяти, а ForEachChunk с участком state.range(1) - по
+// участку, который после первого прохода ещё лежит в кэше. Нулевой участок - обычный код
+void BM_ChunkedTwoPass(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto chunk_size = static_cast<size_t>(state.range(1));
+    Vector<float> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = static_cast<float>(i % 1000) + 1.0f;
+    }
+    const auto two_pass = [](float* first, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            first[i] = first[i] * 0.5f + 1.0f;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            first[i] = std::sqrt(first[i]);
+        }
+    };
+    for (auto _ : state) {
+        if (chunk_size == 0) {
+            two_pass(v.Data(), v.Size());
+        }
+        else {
+            v.ForEachChunk(two_pass, chunk_size);
+        }
+        benchmark::DoNotOptimize(v.begin());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(float)));
+}
+
+enum class SortKind {
+    kStd,       // std::sort в одном потоке
+    kRadix,     // ParallelSort по возрастанию: поразрядная сортировка
+    kMerge,     // ParallelSort с компаратором: сортировка частей и слияния
+};
+
+// Сортировка перемешанных 64-битных ключей. Буфер сортировки переиспользуется между итерациями
+template <SortKind Kind>
+void BM_Sort(benchmark::State& state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    Vector<int64_t> source(n);
+    std::mt19937_64 random(42);
+    for (size_t i = 0; i < n; ++i) {
+        source[i] = static_cast<int64_t>(random());
+    }
+    Vector<int64_t> v;
+    SortBuffer<int64_t> buffer;
+    for (auto _ : state) {
+        state.PauseTiming();
+        v = source;
+        state.ResumeTiming();
+        if constexpr (Kind == SortKind::kStd) {
+            std::sort(v.Data(), v.Data() + v.Size());
+        }
+        else if constexpr (Kind == SortKind::kRadix) {
+            ParallelSort(v, std::less<>(), buffer);
+        }
+        else {
+            ParallelSort(v, [](int64_t lhs, int64_t rhs) { return lhs < rhs; }, buffer);
+        }
+        benchmark::DoNotOptimize(v.Data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+}  // namespace
+
+#define VECTOR_BENCHMARK(Name, T, ...)                                   \
+    BENCHMARK_TEMPLATE(Name, Vector<T>)->__VA_ARGS__;                    \
+    BENCHMARK_TEMPLATE(Name, std::vector<T>)->__VA_ARGS__
+
+#define VECTOR_BENCHMARK_AT(Name, T, Position, ...)                      \
+    BENCHMARK_TEMPLATE(Name, Vector<T>, Position)->__VA_ARGS__;          \
+    BENCHMARK_TEMPLATE(Name, std::vector<T>, Position)->__VA_ARGS__
+
+VECTOR_BENCHMARK(BM_PushBack, int, RangeMultiplier(16)->Range(16, 1 << 20));
+VECTOR_BENCHMARK(BM_PushBack, std::string, RangeMultiplier(16)->Range(16, 1 << 16));
+VECTOR_BENCHMARK(BM_PushBack, ThrowingMove, RangeMultiplier(16)->Range(16, 1 << 16));
+
+VECTOR_BENCHMARK_AT(BM_Insert, int, 0, Arg(1 << 10)->Arg(1 << 13));
+VECTOR_BENCHMARK_AT(BM_Insert, int, 2, Arg(1 << 10)->Arg(1 << 13));
+VECTOR_BENCHMARK_AT(BM_Insert, std::string, 0, Arg(1 << 10)->Arg(1 << 13));
+VECTOR_BENCHMARK_AT(BM_Insert, std::string, 2, Arg(1 << 10)->Arg(1 << 13));
+
+VECTOR_BENCHMARK_AT(BM_Erase, int, 0, Arg(1 << 10)->Arg(1 << 13));
+VECTOR_BENCHMARK_AT(BM_Erase, int, 2, Arg(1 << 10)->Arg(1 << 13));
+VECTOR_BENCHMARK_AT(BM_Erase, std::string, 2, Arg(1 << 10)->Arg(1 << 13));
+
+VECTOR_BENCHMARK(BM_CopyAssignReuse, int, Arg(1 << 10)->Arg(1 << 20));
+VECTOR_BENCHMARK(BM_CopyAssignReuse, std::string, Arg(1 << 10)->Arg(1 << 16));
+
+VECTOR_BENCHMARK(BM_Resize, int, Arg(1 << 10)->Arg(1 << 20));
+VECTOR_BENCHMARK(BM_Resize, std::string, Arg(1 << 10)->Arg(1 << 16));
+
+VECTOR_BENCHMARK(BM_Reserve, int, Arg(1 << 10)->Arg(1 << 20));
+VECTOR_BENCHMARK(BM_Reserve, std::string, Arg(1 << 10)->Arg(1 << 16));
+VECTOR_BENCHMARK(BM_Reserve, ThrowingMove, Arg(1 << 10)->Arg(1 << 16));
+
+#define BULK_BENCHMARK(Name, T, ...)                                     \
+    BENCHMARK_TEMPLATE(Name, T, true)->__VA_ARGS__;                      \
+    BENCHMARK_TEMPLATE(Name, T, false)->__VA_ARGS__
+
+BULK_BENCHMARK(BM_Sum, int, Arg(1 << 12)->Arg(1 << 20));
+BULK_BENCHMARK(BM_Sum, float, Arg(1 << 12)->Arg(1 << 20));
+BULK_BENCHMARK(BM_Find, int, Arg(1 << 12)->Arg(1 << 20));
+BULK_BENCHMARK(BM_Find, double, Arg(1 << 12)->Arg(1 << 20));
+
+BENCHMARK_TEMPLATE(BM_PointerTraversal, false)->Args({ 1 << 12, 0 })->Args({ 1 << 22, 0 });
+BENCHMARK_TEMPLATE(BM_PointerTraversal, true)->ArgsProduct({ { 1 << 12, 1 << 22 }, { 4, 8, 16, 32 } });
+BENCHMARK(BM_ChunkedTwoPass)->ArgsProduct({ { 1 << 24 }, { 0, 1 << 10, 1 << 13, 1 << 16 } });
+
+BENCHMARK_TEMPLATE(BM_Sort, SortKind::kStd)->Arg(1 << 12)->Arg(1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Sort, SortKind::kRadix)->Arg(1 << 12)->Arg(1 << 22)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Sort, SortKind::kMerge)->Arg(1 << 12)->Arg(1 << 22)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,514 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Массовые операции над непрерывными массивами арифметических типов: заполнение, поиск,
+// подсчёт, минимум и максимум, сумма и поэлементное преобразование. Набор инструкций
+// выбирается при первом вызове по возможностям процессора: SSE2, AVX2 или AVX-512 на x86-64,
+// NEON на AArch64. Ядра написаны на векторных расширениях GCC и Clang, поэтому один и тот же
+// код собирается под каждую ширину регистра. Загрузки не требуют выравнивания буфера.
+// Остальные компиляторы и типы используют обычные циклы
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__aarch64__))
+#define ADVANCED_VECTOR_BULK_SIMD 1
+#endif
+
+namespace bulk {
+
+enum class SimdLevel {
+    kScalar,
+    kSse2,
+    kAvx2,
+    kAvx512,
+    kNeon,
+};
+
+enum class TransformOp {
+    kAdd,
+    kSubtract,
+    kMultiply,
+    kMin,
+    kMax,
+};
+
+template <typename T>
+struct MinMaxResult {
+    T min;
+    T max;
+};
+
+// Целые числа суммируются в 64-битном аккумуляторе, числа с плавающей точкой - в самом T
+template <typename T>
+using SumType = std::conditional_t<std::is_floating_point_v<T>, T,
+                                   std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+namespace detail {
+
+template <typename T>
+struct NonDeduced {
+    using Type = T;
+};
+
+template <typename T>
+inline constexpr bool kVectorizable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+                                      && !std::is_same_v<T, long double>
+                                      && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+inline SimdLevel DetectSimdLevel() noexcept {
+#if defined(ADVANCED_VECTOR_BULK_SIMD) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SimdLevel::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::kAvx2;
+    }
+    return SimdLevel::kSse2;
+#elif defined(ADVANCED_VECTOR_BULK_SIMD) && defined(__aarch64__)
+    return SimdLevel::kNeon;
+#else
+    return SimdLevel::kScalar;
+#endif
+}
+
+// Целые складываются и умножаются как беззнаковые, чтобы переполнение было определено
+template <TransformOp Op, typename T>
+T ApplyScalar(T lhs, T rhs) noexcept {
+    using Arith = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, std::common_type<T>>::type;
+    if constexpr (Op == TransformOp::kAdd) {
+        return static_cast<T>(static_cast<Arith>(lhs) + static_cast<Arith>(rhs));
+    }
+    else if constexpr (Op == TransformOp::kSubtract) {
+        return static_cast<T>(static_cast<Arith>(lhs) - static_cast<Arith>(rhs));
+    }
+    else if constexpr (Op == TransformOp::kMultiply) {
+        return static_cast<T>(static_cast<Arith>(lhs) * static_cast<Arith>(rhs));
+    }
+    else if constexpr (Op == TransformOp::kMin) {
+        return lhs < rhs ? lhs : rhs;
+    }
+    else {
+        return lhs > rhs ? lhs : rhs;
+    }
+}
+
+template <TransformOp Op, typename T>
+void TransformScalar(const T* src, size_t count, T* dst, T operand) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = ApplyScalar<Op>(src[i], operand);
+    }
+}
+
+#if defined(ADVANCED_VECTOR_BULK_SIMD)
+
+// Ядра встраиваются в обёртки с атрибутом target и только там получают нужный набор инструкций.
+// Широкие векторы передаются во вспомогательные функции только по ссылке, чтобы их
+// передача не зависела от соглашения о вызовах без AVX
+#define ADVANCED_VECTOR_BULK_INLINE [[gnu::always_inline]] inline
+
+template <typename T, size_t Bytes>
+struct Simd {
+    static constexpr size_t kLanes = Bytes / sizeof(T);
+
+    typedef T Type __attribute__((vector_size(Bytes)));
+    typedef std::make_unsigned_t<std::conditional_t<std::is_integral_v<T>, T, int>> UnsignedLane;
+    typedef UnsignedLane Unsigned __attribute__((vector_size(Bytes)));
+    using Mask = decltype(Type{} == Type{});
+
+    ADVANCED_VECTOR_BULK_INLINE static void Load(Type& value, const T* ptr) noexcept {
+        std::memcpy(&value, ptr, Bytes);
+    }
+
+    ADVANCED_VECTOR_BULK_INLINE static void Store(T* ptr, const Type& value) noexcept {
+        std::memcpy(ptr, &value, Bytes);
+    }
+
+    ADVANCED_VECTOR_BULK_INLINE static bool Any(const Mask& mask) noexcept {
+        uint64_t words[Bytes / 8];
+        std::memcpy(words, &mask, Bytes);
+        uint64_t result = 0;
+        for (size_t i = 0; i < Bytes / 8; ++i) {
+            result |= words[i];
+        }
+        return result != 0;
+    }
+
+    // lhs = lhs op rhs
+    template <TransformOp Op>
+    ADVANCED_VECTOR_BULK_INLINE static void Apply(Type& lhs, const Type& rhs) noexcept {
+        if constexpr (Op == TransformOp::kMin) {
+            lhs = lhs < rhs ? lhs : rhs;
+        }
+        else if constexpr (Op == TransformOp::kMax) {
+            lhs = lhs > rhs ? lhs : rhs;
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            Unsigned a;
+            Unsigned b;
+            std::memcpy(&a, &lhs, Bytes);
+            std::memcpy(&b, &rhs, Bytes);
+            if constexpr (Op == TransformOp::kAdd) {
+                a += b;
+            }
+            else if constexpr (Op == TransformOp::kSubtract) {
+                a -= b;
+            }
+            else {
+                a *= b;
+            }
+            std::memcpy(&lhs, &a, Bytes);
+        }
+        else if constexpr (Op == TransformOp::kAdd) {
+            lhs += rhs;
+        }
+        else if constexpr (Op == TransformOp::kSubtract) {
+            lhs -= rhs;
+        }
+        else {
+            lhs *= rhs;
+        }
+    }
+};
+
+template <size_t Bytes, typename T>
+ADVANCED_VECTOR_BULK_INLINE void FillKernel(T* first, size_t count, T value) noexcept {
+    using S = Simd<T, Bytes>;
+    if (count < S::kLanes) {
+        std::fill_n(first, count, value);
+        return;
+    }
+    const auto fill = typename S::Type{} + value;
+    for (size_t i = 0; i + S::kLanes <= count; i += S::kLanes) {
+        S::Store(first + i, fill);
+    }
+    // Хвост покрывается последним, частично перекрывающимся вектором
+    S::Store(first + count - S::kLanes, fill);
+}
+
+template <size_t Bytes, typename T>
+ADVANCED_VECTOR_BULK_INLINE size_t FindKernel(const T* first, size_t count, T value) noexcept {
+    using S = Simd<T, Bytes>;
+    constexpr size_t kBlock = 4 * S::kLanes;
+    const auto needle = typename S::Type{} + value;
+    size_t i = 0;
+    for (; i + kBlock <= count; i += kBlock) {
+        typename S::Type a;
+        typename S::Type b;
+        typename S::Type c;
+        typename S::Type d;
+        S::Load(a, first + i);
+        S::Load(b, first + i + S::kLanes);
+        S::Load(c, first + i + 2 * S::kLanes);
+        S::Load(d, first + i + 3 * S::kLanes);
+        // Маски складываются вычитанием, а не через |: так GCC не раскладывает
+        // сравнения 512-битных векторов на отдельные элементы
+        typename S::Mask hits{};
+        hits -= a == needle;
+        hits -= b == needle;
+        hits -= c == needle;
+        hits -= d == needle;
+        if (S::Any(hits)) {
+            break;
+        }
+    }
+    // Точную позицию внутри найденного блока, как и хвост, ищет обычный цикл
+    for (; i < count; ++i) {
+        if (first[i] == value) {
+            return i;
+        }
+    }
+    return count;
+}
+
+template <size_t Bytes, typename T>
+ADVANCED_VECTOR_BULK_INLINE size_t CountKernel(const T* first, size_t count, T value) noexcept {
+    using S = Simd<T, Bytes>;
+    // Совпадения накапливаются в знаковых дорожках ширины T, и счётчики сбрасываются до переполнения
+    constexpr size_t kMaxRounds = (size_t{ 1 } << (8 * sizeof(T) - 1)) - 1;
+    const auto needle = typename S::Type{} + value;
+    size_t result = 0;
+    size_t i = 0;
+    while (i + S::kLanes <= count) {
+        const size_t rounds = std::min((count - i) / S::kLanes, kMaxRounds);
+        typename S::Mask counters{};
+        for (size_t round = 0; round < rounds; ++round, i += S::kLanes) {
+            typename S::Type block;
+            S::Load(block, first + i);
+            counters -= block == needle;
+        }
+        for (size_t lane = 0; lane < S::kLanes; ++lane) {
+            result += static_cast<size_t>(counters[lane]);
+        }
+    }
+    for (; i < count; ++i) {
+        result += first[i] == value;
+    }
+    return result;
+}
+
+template <size_t Bytes, typename T>
+ADVANCED_VECTOR_BULK_INLINE MinMaxResult<T> MinMaxKernel(const T* first, size_t count) noexcept {
+    using S = Simd<T, Bytes>;
+    if (count < S::kLanes) {
+        MinMaxResult<T> result{ first[0], first[0] };
+        for (size_t i = 1; i < count; ++i) {
+            result.min = ApplyScalar<TransformOp::kMin>(first[i], result.min);
+            result.max = ApplyScalar<TransformOp::kMax>(first[i], result.max);
+        }
+        return result;
+    }
+    typename S::Type min;
+    S::Load(min, first);
+    auto max = min;
+    // Последний вектор перекрывает предыдущие, но повторный учёт элементов не меняет результат
+    for (size_t i = S::kLanes; i < count + S::kLanes; i += S::kLanes) {
+        typename S::Type block;
+        S::Load(block, first + std::min(i, count - S::kLanes));
+        min = block < min ? block : min;
+        max = block > max ? block : max;
+    }
+    MinMaxResult<T> result{ min[0], max[0] };
+    for (size_t lane = 1; lane < S::kLanes; ++lane) {
+        result.min = ApplyScalar<TransformOp::kMin>(static_cast<T>(min[lane]), result.min);
+        result.max = ApplyScalar<TransformOp::kMax>(static_cast<T>(max[lane]), result.max);
+    }
+    return result;
+}
+
+template <size_t Bytes, typename T>
+ADVANCED_VECTOR_BULK_INLINE SumType<T> SumKernel(const T* first, size_t count) noexcept {
+    using Acc = SumType<T>;
+    size_t i = 0;
+    Acc result{};
+    if constexpr (std::is_floating_point_v<T>) {
+        // Четыре независимых аккумулятора скрывают задержку сложения
+        using S = Simd<T, Bytes>;
+        typename S::Type acc0{};
+        typename S::Type acc1{};
+        typename S::Type acc2{};
+        typename S::Type acc3{};
+        for (; i + 4 * S::kLanes <= count; i += 4 * S::kLanes) {
+            typename S::Type a;
+            typename S::Type b;
+            typename S::Type c;
+            typename S::Type d;
+            S::Load(a, first + i);
+            S::Load(b, first + i + S::kLanes);
+            S::Load(c, first + i + 2 * S::kLanes);
+            S::Load(d, first + i + 3 * S::kLanes);
+            acc0 += a;
+            acc1 += b;
+            acc2 += c;
+            acc3 += d;
+        }
+        const auto total = (acc0 + acc1) + (acc2 + acc3);
+        for (size_t lane = 0; lane < S::kLanes; ++lane) {
+            result += total[lane];
+        }
+    }
+    else {
+        // Элементы расширяются до 64 бит по Bytes / 8 штук за раз
+        constexpr size_t kWide = Bytes / 8;
+        typedef T Narrow __attribute__((vector_size(kWide * sizeof(T))));
+        typedef Acc Wide __attribute__((vector_size(Bytes)));
+        Wide acc{};
+        for (; i + kWide <= count; i += kWide) {
+            Narrow narrow;
+            std::memcpy(&narrow, first + i, sizeof(narrow));
+            acc += __builtin_convertvector(narrow, Wide);
+        }
+        for (size_t lane = 0; lane < kWide; ++lane) {
+            result += acc[lane];
+        }
+    }
+    for (; i < count; ++i) {
+        result += static_cast<Acc>(first[i]);
+    }
+    return result;
+}
+
+template <size_t Bytes, TransformOp Op, typename T>
+ADVANCED_VECTOR_BULK_INLINE void TransformKernel(const T* src, size_t count, T* dst, T operand) noexcept {
+    using S = Simd<T, Bytes>;
+    const auto rhs = typename S::Type{} + operand;
+    size_t i = 0;
+    for (; i + S::kLanes <= count; i += S::kLanes) {
+        typename S::Type block;
+        S::Load(block, src + i);
+        S::template Apply<Op>(block, rhs);
+        S::Store(dst + i, block);
+    }
+    TransformScalar<Op>(src + i, count - i, dst + i, operand);
+}
+
+// Обёртки ядер под конкретный набор инструкций
+#define ADVANCED_VECTOR_BULK_TARGET(Suffix, Target, Bytes)                                        \
+    template <typename T>                                                                         \
+    Target void Fill##Suffix(T* first, size_t count, T value) noexcept {                          \
+        FillKernel<Bytes>(first, count, value);                                                   \
+    }                                                                                             \
+    template <typename T>                                                                         \
+    Target size_t Find##Suffix(const T* first, size_t count, T value) noexcept {                  \
+        return FindKernel<Bytes>(first, count, value);                                            \
+    }                                                                                             \
+    template <typename T>                                                                         \
+    Target size_t Count##Suffix(const T* first, size_t count, T value) noexcept {                 \
+        return CountKernel<Bytes>(first, count, value);                                           \
+    }                                                                                             \
+    template <typename T>                                                                         \
+    Target MinMaxResult<T> MinMax##Suffix(const T* first, size_t count) noexcept {                \
+        return MinMaxKernel<Bytes>(first, count);                                                 \
+    }                                                                                             \
+    template <typename T>                                                                         \
+    Target SumType<T> Sum##Suffix(const T* first, size_t count) noexcept {                        \
+        return SumKernel<Bytes>(first, count);                                                    \
+    }                                                                                             \
+    template <TransformOp Op, typename T>                                                         \
+    Target void Transform##Suffix(const T* src, size_t count, T* dst, T operand) noexcept {       \
+        TransformKernel<Bytes, Op>(src, count, dst, operand);                                     \
+    }
+
+// SSE2 и NEON входят в базовый набор инструкций своих архитектур
+ADVANCED_VECTOR_BULK_TARGET(Base, , 16)
+#if defined(__x86_64__)
+ADVANCED_VECTOR_BULK_TARGET(Avx2, [[gnu::target("avx2")]], 32)
+ADVANCED_VECTOR_BULK_TARGET(Avx512, [[gnu::target("avx512f,avx512bw")]], 64)
+#endif
+
+#undef ADVANCED_VECTOR_BULK_TARGET
+#undef ADVANCED_VECTOR_BULK_INLINE
+
+// Вызывает ядро Name под доступный набор инструкций (за именем следуют аргументы вызова)
+// или ничего не делает, оставляя работу обычному циклу
+#if defined(__x86_64__)
+#define ADVANCED_VECTOR_BULK_DISPATCH(Name, ...) \
+    switch (GetSimdLevel()) {                                \
+    case SimdLevel::kAvx512:                                 \
+        return detail::Name##Avx512 __VA_ARGS__;            \
+    case SimdLevel::kAvx2:                                   \
+        return detail::Name##Avx2 __VA_ARGS__;              \
+    case SimdLevel::kSse2:                                   \
+        return detail::Name##Base __VA_ARGS__;              \
+    default:                                                 \
+        break;                                               \
+    }
+#else
+#define ADVANCED_VECTOR_BULK_DISPATCH(Name, ...) \
+    if (GetSimdLevel() == SimdLevel::kNeon) {                \
+        return detail::Name##Base __VA_ARGS__;              \
+    }
+#endif
+
+#else
+#define ADVANCED_VECTOR_BULK_DISPATCH(Name, ...)
+#endif  // ADVANCED_VECTOR_BULK_SIMD
+
+}  // namespace detail
+
+// Набор инструкций, который используют массовые операции. Определяется один раз
+inline SimdLevel GetSimdLevel() noexcept {
+    static const SimdLevel level = detail::DetectSimdLevel();
+    return level;
+}
+
+template <typename T>
+void Fill(T* first, size_t count, typename detail::NonDeduced<T>::Type value) noexcept {
+    if constexpr (detail::kVectorizable<T>) {
+        ADVANCED_VECTOR_BULK_DISPATCH(Fill, (first, count, value))
+    }
+    std::fill_n(first, count, value);
+}
+
+// Возвращает индекс первого элемента, равного value, или count, если такого нет
+template <typename T>
+size_t Find(const T* first, size_t count, typename detail::NonDeduced<T>::Type value) noexcept {
+    if constexpr (detail::kVectorizable<T>) {
+        ADVANCED_VECTOR_BULK_DISPATCH(Find, (first, count, value))
+    }
+    return static_cast<size_t>(std::find(first, first + count, value) - first);
+}
+
+template <typename T>
+size_t Count(const T* first, size_t count, typename detail::NonDeduced<T>::Type value) noexcept {
+    if constexpr (detail::kVectorizable<T>) {
+        ADVANCED_VECTOR_BULK_DISPATCH(Count, (first, count, value))
+    }
+    return static_cast<size_t>(std::count(first, first + count, value));
+}
+
+// Требует count > 0. NaN среди чисел с плавающей точкой дают неопределённый результат
+template <typename T>
+MinMaxResult<T> MinMax(const T* first, size_t count) noexcept {
+    assert(count > 0);
+    if constexpr (detail::kVectorizable<T>) {
+        ADVANCED_VECTOR_BULK_DISPATCH(MinMax, (first, count))
+    }
+    MinMaxResult<T> result{ first[0], first[0] };
+    for (size_t i = 1; i < count; ++i) {
+        result.min = detail::ApplyScalar<TransformOp::kMin>(first[i], result.min);
+        result.max = detail::ApplyScalar<TransformOp::kMax>(first[i], result.max);
+    }
+    return result;
+}
+
+// Числа с плавающей точкой складываются в нескольких независимых суммах, поэтому
+// результат может отличаться от последовательного сложения в пределах погрешности округления
+template <typename T>
+SumType<T> Sum(const T* first, size_t count) noexcept {
+    if constexpr (detail::kVectorizable<T>) {
+        ADVANCED_VECTOR_BULK_DISPATCH(Sum, (first, count))
+    }
+    SumType<T> result{};
+    for (size_t i = 0; i < count; ++i) {
+        result += static_cast<SumType<T>>(first[i]);
+    }
+    return result;
+}
+
+// Записывает в dst[i] результат src[i] op operand. Массивы src и dst совпадают или не пересекаются
+template <TransformOp Op, typename T>
+void Transform(const T* src, size_t count, T* dst, typename detail::NonDeduced<T>::Type operand) noexcept {
+    if constexpr (detail::kVectorizable<T>) {
+        ADVANCED_VECTOR_BULK_DISPATCH(Transform, <Op>(src, count, dst, operand))
+    }
+    detail::TransformScalar<Op>(src, count, dst, operand);
+}
+
+#undef ADVANCED_VECTOR_BULK_DISPATCH
+
+template <typename T, typename Storage, typename GrowthPolicy>
+void Fill(BasicVector<T, Storage, GrowthPolicy>& v, typename detail::NonDeduced<T>::Type value) noexcept {
+    Fill(v.Data(), v.Size(), value);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy>
+size_t Find(const BasicVector<T, Storage, GrowthPolicy>& v, typename detail::NonDeduced<T>::Type value) noexcept {
+    return Find(v.Data(), v.Size(), value);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy>
+size_t Count(const BasicVector<T, Storage, GrowthPolicy>& v, typename detail::NonDeduced<T>::Type value) noexcept {
+    return Count(v.Data(), v.Size(), value);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy>
+MinMaxResult<T> MinMax(const BasicVector<T, Storage, GrowthPolicy>& v) noexcept {
+    return MinMax(v.Data(), v.Size());
+}
+
+template <typename T, typename Storage, typename GrowthPolicy>
+SumType<T> Sum(const BasicVector<T, Storage, GrowthPolicy>& v) noexcept {
+    return Sum(v.Data(), v.Size());
+}
+
+template <TransformOp Op, typename T, typename Storage, typename GrowthPolicy>
+void Transform(BasicVector<T, Storage, GrowthPolicy>& v, typename detail::NonDeduced<T>::Type operand) noexcept {
+    Transform<Op>(v.Data(), v.Size(), v.Data(), operand);
+}
+
+}  // namespace bulk
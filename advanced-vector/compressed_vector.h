@@ -0,0 +1,330 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Сжатый массив целых чисел. Элементы делятся на блоки по kBlockSize штук; в каждом
+// полном блоке хранится наименьшее значение (опорное), а остальные записываются как
+// разности с ним, упакованные по bits бит, где bits - ширина наибольшей разности блока
+// (frame-of-reference). Отсортированные идентификаторы и небольшие счётчики занимают
+// так 1-2 байта вместо 8.
+//
+// Последний блок хранится несжатым и упаковывается, когда в него не помещается новый
+// элемент. Доступ к элементу по индексу извлекает его биты без распаковки блока, а
+// ForEachBlock и DecodeBlock распаковывают блок целиком функцией, скомпилированной для
+// ширины блока, так что компилятор разворачивает и векторизует её цикл
+template <typename Int, typename Allocator = std::allocator<Int>>
+class CompressedVector {
+    static_assert(std::is_integral_v<Int> && sizeof(Int) <= sizeof(uint64_t), "CompressedVector requires integers up to 64 bits");
+
+    using Unsigned = std::make_unsigned_t<Int>;
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    static constexpr size_t kBlockSize = 128;
+
+private:
+    static constexpr size_t kWordBits = 64;
+    static constexpr size_t kMaxBits = std::numeric_limits<Unsigned>::digits;
+
+    struct BlockHeader {
+        size_t offset;  // первое слово блока в words_
+        Unsigned base;
+        uint8_t bits;
+    };
+
+    using Words = Vector<uint64_t, typename AllocTraits::template rebind_alloc<uint64_t>>;
+    using Headers = Vector<BlockHeader, typename AllocTraits::template rebind_alloc<BlockHeader>>;
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Int;
+
+        const_iterator() = default;
+
+        const_iterator(const CompressedVector* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        Int operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        Int operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        const_iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            const_iterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        const_iterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            const_iterator copy = *this;
+            --index_;
+            return copy;
+        }
+
+        const_iterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        const_iterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend const_iterator operator+(const_iterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend const_iterator operator+(difference_type offset, const_iterator it) noexcept {
+            return it += offset;
+        }
+
+        friend const_iterator operator-(const_iterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const const_iterator& lhs, const const_iterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        const CompressedVector* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using allocator_type = Allocator;
+    using iterator = const_iterator;
+
+    CompressedVector() = default;
+
+    explicit CompressedVector(const Allocator& alloc)
+        : words_(typename Words::allocator_type(alloc))
+        , headers_(typename Headers::allocator_type(alloc)) {
+    }
+
+    // Сжимает элементы v
+    template <typename Storage, typename GrowthPolicy>
+    explicit CompressedVector(const BasicVector<Int, Storage, GrowthPolicy>& v, const Allocator& alloc = Allocator())
+        : CompressedVector(alloc) {
+        for (Int value : v) {
+            EmplaceBack(value);
+        }
+    }
+
+    void EmplaceBack(Int value) {
+        // Заполненный хвост упаковывается при следующем добавлении: если упаковка
+        // выбросит исключение, массив останется прежним
+        if (tail_size_ == kBlockSize) {
+            PackTail();
+        }
+        tail_[tail_size_++] = value;
+    }
+
+    void PushBack(Int value) {
+        EmplaceBack(value);
+    }
+
+    void Clear() noexcept {
+        words_.Clear(true);
+        headers_.Clear(true);
+        tail_size_ = 0;
+    }
+
+    Int operator[](size_t index) const noexcept {
+        assert(index < Size());
+        const size_t block = index / kBlockSize;
+        const size_t position = index % kBlockSize;
+        if (block == headers_.Size()) {
+            return tail_[position];
+        }
+        const BlockHeader& header = headers_[block];
+        if (header.bits == 0) {
+            return static_cast<Int>(header.base);
+        }
+        const size_t bit = position * header.bits;
+        const uint64_t* words = words_.Data() + header.offset + bit / kWordBits;
+        const size_t shift = bit % kWordBits;
+        uint64_t delta = words[0] >> shift;
+        if (shift + header.bits > kWordBits) {
+            delta |= words[1] << (kWordBits - shift);
+        }
+        if (header.bits < kWordBits) {
+            delta &= (uint64_t{ 1 } << header.bits) - 1;
+        }
+        return static_cast<Int>(static_cast<Unsigned>(header.base + delta));
+    }
+
+    size_t Size() const noexcept {
+        return headers_.Size() * kBlockSize + tail_size_;
+    }
+
+    // Число блоков, включая несжатый последний
+    size_t BlockCount() const noexcept {
+        return headers_.Size() + (tail_size_ != 0 ? 1 : 0);
+    }
+
+    // Распаковывает блок block в out (не меньше kBlockSize элементов) и возвращает число его элементов
+    size_t DecodeBlock(size_t block, Int* out) const noexcept {
+        assert(block < BlockCount());
+        if (block == headers_.Size()) {
+            std::copy_n(tail_, tail_size_, out);
+            return tail_size_;
+        }
+        const BlockHeader& header = headers_[block];
+        kDecoders[header.bits](words_.Data() + header.offset, header.base, out);
+        return kBlockSize;
+    }
+
+    // Передаёт fn(first, count) распакованные блоки по порядку
+    template <typename Fn>
+    void ForEachBlock(Fn&& fn) const {
+        Int buffer[kBlockSize];
+        for (size_t block = 0, count = BlockCount(); block < count; ++block) {
+            fn(static_cast<const Int*>(buffer), DecodeBlock(block, buffer));
+        }
+    }
+
+    // Распаковывает элементы в обычный вектор
+    Vector<Int, Allocator> ToVector() const {
+        Vector<Int, Allocator> result;
+        result.ResizeDefaultInit(Size());
+        for (size_t block = 0, count = BlockCount(); block < count; ++block) {
+            DecodeBlock(block, result.Data() + block * kBlockSize);
+        }
+        return result;
+    }
+
+    // Байты, занимаемые сжатыми данными, заголовками блоков и несжатым хвостом
+    size_t MemoryUsage() const noexcept {
+        return words_.Capacity() * sizeof(uint64_t) + headers_.Capacity() * sizeof(BlockHeader) + sizeof(tail_);
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, Size());
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    using Decoder = void (*)(const uint64_t* words, Unsigned base, Int* out) noexcept;
+
+    // Распаковка блока ширины Bits: сдвиги и маски известны при компиляции
+    template <size_t Bits>
+    static void Decode(const uint64_t* words, Unsigned base, Int* out) noexcept {
+        if constexpr (Bits == 0) {
+            std::fill_n(out, kBlockSize, static_cast<Int>(base));
+        }
+        else {
+            for (size_t i = 0; i < kBlockSize; ++i) {
+                const size_t bit = i * Bits;
+                const size_t shift = bit % kWordBits;
+                uint64_t delta = words[bit / kWordBits] >> shift;
+                if constexpr (Bits < kWordBits) {
+                    if (shift + Bits > kWordBits) {
+                        delta |= words[bit / kWordBits + 1] << (kWordBits - shift);
+                    }
+                    delta &= (uint64_t{ 1 } << Bits) - 1;
+                }
+                out[i] = static_cast<Int>(static_cast<Unsigned>(base + delta));
+            }
+        }
+    }
+
+    template <size_t... Bits>
+    static constexpr std::array<Decoder, sizeof...(Bits)> MakeDecoders(std::index_sequence<Bits...>) noexcept {
+        return { &Decode<Bits>... };
+    }
+
+    static constexpr std::array<Decoder, kMaxBits + 1> kDecoders = MakeDecoders(std::make_index_sequence<kMaxBits + 1>{});
+
+    void PackTail() {
+        const auto [min, max] = std::minmax_element(tail_, tail_ + kBlockSize);
+        const Unsigned base = static_cast<Unsigned>(*min);
+        const uint64_t range = static_cast<Unsigned>(static_cast<Unsigned>(*max) - base);
+        uint8_t bits = 0;
+        while (bits < kMaxBits && (range >> bits) != 0) {
+            ++bits;
+        }
+        // Блок из 128 элементов ширины bits занимает ровно 2 * bits слов
+        const size_t offset = words_.Size();
+        headers_.Reserve(headers_.Size() + 1);
+        words_.Resize(offset + kBlockSize * bits / kWordBits);
+        for (size_t i = 0; i < kBlockSize && bits != 0; ++i) {
+            const uint64_t delta = static_cast<Unsigned>(static_cast<Unsigned>(tail_[i]) - base);
+            const size_t bit = i * bits;
+            const size_t shift = bit % kWordBits;
+            words_[offset + bit / kWordBits] |= delta << shift;
+            if (shift + bits > kWordBits) {
+                words_[offset + bit / kWordBits + 1] |= delta >> (kWordBits - shift);
+            }
+        }
+        headers_.PushBack(BlockHeader{ offset, base, bits });
+        tail_size_ = 0;
+    }
+
+    Words words_;
+    Headers headers_;
+    Int tail_[kBlockSize] = {};
+    size_t tail_size_ = 0;
+};
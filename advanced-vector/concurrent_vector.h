@@ -0,0 +1,261 @@
+#pragma once
+#include "stable_vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Массив, в который несколько потоков добавляют элементы без блокировок. EmplaceBack
+// занимает место атомарным увеличением счётчика и создаёт элемент в своей ячейке, после
+// чего помечает её готовой. Читатели видят только готовые элементы: TryGet возвращает
+// nullptr, пока элемент в ячейке ещё создаётся.
+//
+// Как и в StableVector, элементы лежат в блоках и при росте не переносятся, поэтому ссылки
+// на них остаются действительными. Каталог блоков не может расти без блокировки, поэтому
+// его размер фиксирован, а блоки растут геометрически: первый вмещает FirstChunkSize
+// элементов, каждый следующий - столько же, сколько все предыдущие вместе. Блок выделяет
+// поток, первым обратившийся к нему; если таких потоков несколько, лишние блоки освобождаются.
+//
+// Если конструктор элемента выбросил исключение, его ячейка остаётся занятой, но никогда
+// не становится готовой. Clear, Swap и перемещение не должны выполняться одновременно
+// с другими операциями
+template <typename T, size_t FirstChunkSize = detail::DefaultChunkSize<T>(), typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+    static_assert(FirstChunkSize != 0 && (FirstChunkSize & (FirstChunkSize - 1)) == 0,
+                  "FirstChunkSize must be a power of two");
+
+    struct Slot {
+        std::atomic<bool> ready;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* Get() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+    using SlotTraits = std::allocator_traits<SlotAllocator>;
+
+    static constexpr size_t kFirstChunkShift = [] {
+        size_t shift = 0;
+        while ((size_t{ 1 } << shift) != FirstChunkSize) {
+            ++shift;
+        }
+        return shift;
+    }();
+    // Блоков хватает, чтобы адресовать любой индекс size_t
+    static constexpr size_t kMaxChunks = std::numeric_limits<size_t>::digits - kFirstChunkShift + 1;
+
+public:
+    using allocator_type = Allocator;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ConcurrentVector(ConcurrentVector&& other) noexcept
+        : alloc_(other.alloc_) {
+        Swap(other);
+    }
+
+    ConcurrentVector& operator=(ConcurrentVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~ConcurrentVector() {
+        Clear();
+        SlotAllocator slot_alloc(alloc_);
+        for (size_t chunk = 0; chunk < kMaxChunks; ++chunk) {
+            if (Slot* slots = chunks_[chunk].load(std::memory_order_relaxed)) {
+                SlotTraits::deallocate(slot_alloc, slots, ChunkCapacity(chunk));
+            }
+        }
+    }
+
+    void Swap(ConcurrentVector& other) noexcept {
+        using std::swap;
+        swap(alloc_, other.alloc_);
+        for (size_t chunk = 0; chunk < kMaxChunks; ++chunk) {
+            Slot* slots = chunks_[chunk].load(std::memory_order_relaxed);
+            chunks_[chunk].store(other.chunks_[chunk].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.chunks_[chunk].store(slots, std::memory_order_relaxed);
+        }
+        const size_t size = size_.load(std::memory_order_relaxed);
+        size_.store(other.size_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.size_.store(size, std::memory_order_relaxed);
+    }
+
+    // Потокобезопасно добавляет элемент и возвращает ссылку на него
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = GetSlot(index);
+        T* item = new (slot.storage) T(std::forward<Args>(args)...);
+        slot.ready.store(true, std::memory_order_release);
+        return *item;
+    }
+
+    T& PushBack(const T& value) {
+        return EmplaceBack(value);
+    }
+
+    T& PushBack(T&& value) {
+        return EmplaceBack(std::move(value));
+    }
+
+    // Потокобезопасно выделяет блоки так, чтобы вместить capacity элементов
+    void Reserve(size_t capacity) {
+        if (capacity != 0) {
+            for (size_t chunk = 0, last = ChunkOf(capacity - 1); chunk <= last; ++chunk) {
+                LoadOrAllocateChunk(chunk);
+            }
+        }
+    }
+
+    // Разрушает все готовые элементы. Выделенные блоки остаются в резерве
+    void Clear() noexcept {
+        ForEach([](T& item) {
+            std::destroy_at(&item);
+        });
+        const size_t size = size_.load(std::memory_order_relaxed);
+        for (size_t chunk = 0; chunk < kMaxChunks && ChunkBegin(chunk) < size; ++chunk) {
+            if (Slot* slots = chunks_[chunk].load(std::memory_order_relaxed)) {
+                for (size_t i = 0, count = std::min(ChunkCapacity(chunk), size - ChunkBegin(chunk)); i < count; ++i) {
+                    slots[i].ready.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+    // Возвращает элемент, если он уже создан, иначе nullptr
+    T* TryGet(size_t index) noexcept {
+        if (index >= Size()) {
+            return nullptr;
+        }
+        Slot* slots = chunks_[ChunkOf(index)].load(std::memory_order_acquire);
+        if (slots == nullptr) {
+            return nullptr;
+        }
+        Slot& slot = slots[index - ChunkBegin(ChunkOf(index))];
+        return slot.ready.load(std::memory_order_acquire) ? slot.Get() : nullptr;
+    }
+
+    const T* TryGet(size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this).TryGet(index);
+    }
+
+    // Элемент должен быть готов, например возвращён EmplaceBack этого же потока
+    T& operator[](size_t index) noexcept {
+        T* item = TryGet(index);
+        assert(item != nullptr);
+        return *item;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    // Число занятых ячеек, включая ещё не созданные элементы
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Передаёт fn готовые элементы по порядку индексов, пропуская те, что ещё создаются
+    template <typename Fn>
+    void ForEach(Fn&& fn) {
+        VisitReady(*this, fn);
+    }
+
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        VisitReady(*this, fn);
+    }
+
+private:
+    // Блок, в котором лежит элемент index: нулевой - для [0, FirstChunkSize),
+    // блок k > 0 - для [FirstChunkSize << (k - 1), FirstChunkSize << k)
+    static size_t ChunkOf(size_t index) noexcept {
+        const size_t quotient = index >> kFirstChunkShift;
+#if defined(__GNUC__)
+        return quotient == 0 ? 0 : std::numeric_limits<unsigned long long>::digits - __builtin_clzll(quotient);
+#else
+        size_t chunk = 0;
+        for (size_t rest = quotient; rest != 0; rest >>= 1) {
+            ++chunk;
+        }
+        return chunk;
+#endif
+    }
+
+    static size_t ChunkBegin(size_t chunk) noexcept {
+        return chunk == 0 ? 0 : FirstChunkSize << (chunk - 1);
+    }
+
+    static size_t ChunkCapacity(size_t chunk) noexcept {
+        return chunk == 0 ? FirstChunkSize : FirstChunkSize << (chunk - 1);
+    }
+
+    Slot& GetSlot(size_t index) {
+        const size_t chunk = ChunkOf(index);
+        return LoadOrAllocateChunk(chunk)[index - ChunkBegin(chunk)];
+    }
+
+    Slot* LoadOrAllocateChunk(size_t chunk) {
+        Slot* slots = chunks_[chunk].load(std::memory_order_acquire);
+        if (slots != nullptr) {
+            return slots;
+        }
+        const size_t capacity = ChunkCapacity(chunk);
+        SlotAllocator slot_alloc(alloc_);
+        Slot* fresh = SlotTraits::allocate(slot_alloc, capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            new (&fresh[i].ready) std::atomic<bool>(false);
+        }
+        if (chunks_[chunk].compare_exchange_strong(slots, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return fresh;
+        }
+        // Другой поток успел установить свой блок
+        SlotTraits::deallocate(slot_alloc, fresh, capacity);
+        return slots;
+    }
+
+    template <typename Self, typename Fn>
+    static void VisitReady(Self& self, Fn& fn) {
+        using Item = std::conditional_t<std::is_const_v<Self>, const T, T>;
+        const size_t size = self.Size();
+        for (size_t chunk = 0; chunk < kMaxChunks && ChunkBegin(chunk) < size; ++chunk) {
+            Slot* slots = self.chunks_[chunk].load(std::memory_order_acquire);
+            if (slots == nullptr) {
+                continue;
+            }
+            for (size_t i = 0, count = std::min(ChunkCapacity(chunk), size - ChunkBegin(chunk)); i < count; ++i) {
+                if (slots[i].ready.load(std::memory_order_acquire)) {
+                    fn(static_cast<Item&>(*slots[i].Get()));
+                }
+            }
+        }
+    }
+
+    [[no_unique_address]] Allocator alloc_;
+    std::atomic<Slot*> chunks_[kMaxChunks] = {};
+    std::atomic<size_t> size_{ 0 };
+};
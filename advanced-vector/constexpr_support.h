@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Вычисление векторов на этапе компиляции. В C++20, где std::allocator и std::construct_at
+// допускают вычисление при компиляции, основные операции Vector и StaticVector объявлены constexpr:
+//     constexpr int SumOfSquares(int n) {
+//         Vector<int> v;
+//         for (int i = 1; i <= n; ++i) {
+//             v.PushBack(i * i);
+//         }
+//         return std::accumulate(v.begin(), v.end(), 0);
+//     }
+//     static_assert(SumOfSquares(3) == 14);
+// Память, выделенная при компиляции, должна быть освобождена там же: таблицу, построенную
+// в Vector, нужно скопировать в std::array. В C++17 макрос пуст, и операции обычные.
+// Примеры вычислений при компиляции собраны в tests/constexpr_test.cpp
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && defined(__cpp_lib_is_constant_evaluated)
+#define ADVANCED_VECTOR_CONSTEXPR constexpr
+#else
+#define ADVANCED_VECTOR_CONSTEXPR
+#endif
+
+namespace detail {
+
+// Выполняется ли вызов при вычислении на этапе компиляции. Там недоступны memcpy, memmove
+// и std::uninitialized_*, и контейнеры переходят на поштучную работу с элементами
+constexpr bool IsConstantEvaluated() noexcept {
+#ifdef __cpp_lib_is_constant_evaluated
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+template <typename T, typename... Args>
+ADVANCED_VECTOR_CONSTEXPR T* ConstructAt(T* ptr, Args&&... args) {
+#ifdef __cpp_lib_constexpr_dynamic_alloc
+    return std::construct_at(ptr, std::forward<Args>(args)...);
+#else
+    return ::new (static_cast<void*>(ptr)) T(std::forward<Args>(args)...);
+#endif
+}
+
+// Аналоги std::uninitialized_*, допустимые при вычислении на этапе компиляции. Исключение
+// там делает вычисление невозможным, поэтому откатывать созданные элементы не нужно.
+// Инициализация по умолчанию при компиляции заменяется инициализацией значением
+template <typename T>
+ADVANCED_VECTOR_CONSTEXPR void UninitializedValueConstructN(T* first, size_t count) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < count; ++i) {
+            ConstructAt(first + i);
+        }
+        return;
+    }
+    std::uninitialized_value_construct_n(first, count);
+}
+
+template <typename T>
+ADVANCED_VECTOR_CONSTEXPR void UninitializedDefaultConstructN(T* first, size_t count) {
+    if (IsConstantEvaluated()) {
+        UninitializedValueConstructN(first, count);
+        return;
+    }
+    std::uninitialized_default_construct_n(first, count);
+}
+
+template <typename InputIt, typename T>
+ADVANCED_VECTOR_CONSTEXPR void UninitializedCopyN(InputIt from, size_t count, T* to) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < count; ++i, ++from) {
+            ConstructAt(to + i, *from);
+        }
+        return;
+    }
+    std::uninitialized_copy_n(from, count, to);
+}
+
+template <typename T>
+ADVANCED_VECTOR_CONSTEXPR void UninitializedMoveN(T* from, size_t count, T* to) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < count; ++i) {
+            ConstructAt(to + i, std::move(from[i]));
+        }
+        return;
+    }
+    std::uninitialized_move_n(from, count, to);
+}
+
+template <typename T>
+ADVANCED_VECTOR_CONSTEXPR void UninitializedFillN(T* to, size_t count, const T& value) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < count; ++i) {
+            ConstructAt(to + i, value);
+        }
+        return;
+    }
+    std::uninitialized_fill_n(to, count, value);
+}
+
+}  // namespace detail
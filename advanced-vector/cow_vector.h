@@ -0,0 +1,356 @@
+#pragma once
+#include "stable_vector.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// Массив с копированием при записи. Как и в StableVector, элементы лежат в блоках по
+// ChunkSize штук, но блоки и их каталог разделяются между копиями через счётчик ссылок.
+// Копирование вектора лишь увеличивает счётчик ссылок каталога, поэтому снимок огромного
+// массива стоит O(1). Изменяющая операция сначала отделяет от других копий каталог, а затем
+// только те блоки, которые она затрагивает: EmplaceBack копирует последний блок, запись через
+// operator[] - блок элемента, Erase - блоки от удаляемого элемента до конца.
+//
+// Разные объекты CowVector, даже разделяющие блоки, можно использовать из разных потоков
+// без синхронизации, как и std::shared_ptr. Один и тот же объект требует внешней синхронизации.
+// Читайте через константную ссылку: неконстантный operator[] отделяет блок даже при чтении.
+//
+// Изменяемая ссылка, которую вернули operator[] или EmplaceBack, указывает в блок этого вектора
+// и не переживает его копирования: копия разделяет тот же блок, и запись через старую ссылку
+// изменила бы обе. После копирования ссылку нужно получить заново - тогда блок будет отделён:
+//     T& item = v[0];
+//     CowVector<T> snapshot = v;  // item больше нельзя использовать для записи
+//     v[0] = value;               // snapshot не меняется
+template <typename T, size_t ChunkSize = detail::DefaultChunkSize<T>(), typename Allocator = std::allocator<T>>
+class CowVector {
+    static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    // Блок знает, сколько элементов в нём создано: все владельцы блока видят одни и те же
+    // элементы, так как перед изменением блок отделяется от остальных владельцев
+    struct Chunk {
+        explicit Chunk(const Allocator& alloc)
+            : memory(ChunkSize, alloc) {
+        }
+
+        Chunk(const Chunk&) = delete;
+        Chunk& operator=(const Chunk&) = delete;
+
+        ~Chunk() {
+            std::destroy_n(memory.GetAddress(), size);
+        }
+
+        RawMemory<T, Allocator> memory;
+        size_t size = 0;
+    };
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using ChunkPtr = std::shared_ptr<Chunk>;
+    using Directory = Vector<ChunkPtr, typename AllocTraits::template rebind_alloc<ChunkPtr>>;
+
+    class ConstIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        ConstIterator() = default;
+
+        ConstIterator(const CowVector* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        ConstIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        ConstIterator operator++(int) noexcept {
+            ConstIterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        ConstIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        ConstIterator operator--(int) noexcept {
+            ConstIterator copy = *this;
+            --index_;
+            return copy;
+        }
+
+        ConstIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        ConstIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend ConstIterator operator+(ConstIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend ConstIterator operator+(difference_type offset, ConstIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend ConstIterator operator-(ConstIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class CowVector;
+
+        const CowVector* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using allocator_type = Allocator;
+    using const_iterator = ConstIterator;
+
+    static constexpr size_t kChunkSize = ChunkSize;
+
+    CowVector() = default;
+
+    explicit CowVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Копии разделяют блоки и каталог
+    CowVector(const CowVector& other) = default;
+    CowVector& operator=(const CowVector& rhs) = default;
+
+    CowVector(CowVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , chunks_(std::move(other.chunks_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    void Swap(CowVector& other) noexcept {
+        using std::swap;
+        swap(alloc_, other.alloc_);
+        chunks_.swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    // Ссылка на новый элемент, как и ссылка из operator[], пригодна для записи до ближайшего копирования
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        Directory& directory = MutableDirectory();
+        const size_t chunk = size_ / ChunkSize;
+        if (chunk == directory.Size()) {
+            directory.EmplaceBack(MakeChunk());
+        }
+        ChunkPtr& target = directory[chunk];
+        T* slot = nullptr;
+        if (IsShared(target)) {
+            // Аргументы могут ссылаться на элементы прежнего блока, поэтому он заменяется
+            // копией только после создания нового элемента
+            ChunkPtr copy = CloneChunk(*target);
+            slot = new (copy->memory + copy->size) T(std::forward<Args>(args)...);
+            ++copy->size;
+            target = std::move(copy);
+        }
+        else {
+            slot = new (target->memory + target->size) T(std::forward<Args>(args)...);
+            ++target->size;
+        }
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() {
+        assert(size_ > 0);
+        Chunk& chunk = MutableChunk((size_ - 1) / ChunkSize);
+        --chunk.size;
+        std::destroy_at(chunk.memory + chunk.size);
+        --size_;
+    }
+
+    // Удаляет элемент pos, сдвигая следующие за ним. Отделяет блоки от pos до конца
+    const_iterator Erase(const_iterator pos) {
+        assert(pos.index_ < size_);
+        const size_t index = pos.index_;
+        for (size_t chunk = index / ChunkSize, last = (size_ - 1) / ChunkSize; chunk <= last; ++chunk) {
+            MutableChunk(chunk);
+        }
+        for (size_t i = index; i + 1 < size_; ++i) {
+            ElementAt(i) = std::move(ElementAt(i + 1));
+        }
+        PopBack();
+        return const_iterator(this, index);
+    }
+
+    // Отпускает блоки; если они не разделены с другими копиями, элементы разрушаются
+    void Clear() noexcept {
+        chunks_.reset();
+        size_ = 0;
+    }
+
+    // Возвращает изменяемый элемент, предварительно отделив его блок от других копий.
+    // Ссылка пригодна для записи до ближайшего копирования вектора
+    T& operator[](size_t index) {
+        assert(index < size_);
+        return MutableChunk(index / ChunkSize).memory[index % ChunkSize];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return ElementAt(index);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return chunks_ ? chunks_->Size() * ChunkSize : 0;
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Передаёт fn(first, count) непрерывные участки элементов блок за блоком
+    template <typename Fn>
+    void ForEachChunk(Fn&& fn) const {
+        size_t remaining = size_;
+        for (size_t chunk = 0; remaining != 0; ++chunk) {
+            const size_t count = std::min(remaining, ChunkSize);
+            fn(static_cast<const T*>((*chunks_)[chunk]->memory.GetAddress()), count);
+            remaining -= count;
+        }
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    // Объект, которым владеет только этот вектор, можно менять. Барьер упорядочивает
+    // запись после чтений, которые другие владельцы выполнили до того, как отпустить объект
+    template <typename Object>
+    static bool IsShared(const std::shared_ptr<Object>& ptr) noexcept {
+        if (ptr.use_count() != 1) {
+            return true;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return false;
+    }
+
+    T& ElementAt(size_t index) const noexcept {
+        return (*chunks_)[index / ChunkSize]->memory[index % ChunkSize];
+    }
+
+    ChunkPtr MakeChunk() const {
+        using ChunkAllocator = typename AllocTraits::template rebind_alloc<Chunk>;
+        return std::allocate_shared<Chunk>(ChunkAllocator(alloc_), alloc_);
+    }
+
+    ChunkPtr CloneChunk(const Chunk& chunk) const {
+        ChunkPtr copy = MakeChunk();
+        std::uninitialized_copy_n(chunk.memory.GetAddress(), chunk.size, copy->memory.GetAddress());
+        copy->size = chunk.size;
+        return copy;
+    }
+
+    Directory& MutableDirectory() {
+        using DirectoryAllocator = typename AllocTraits::template rebind_alloc<Directory>;
+        if (!chunks_) {
+            chunks_ = std::allocate_shared<Directory>(DirectoryAllocator(alloc_), typename Directory::allocator_type(alloc_));
+        }
+        else if (IsShared(chunks_)) {
+            chunks_ = std::allocate_shared<Directory>(DirectoryAllocator(alloc_), *chunks_);
+        }
+        return *chunks_;
+    }
+
+    Chunk& MutableChunk(size_t chunk) {
+        ChunkPtr& target = MutableDirectory()[chunk];
+        if (IsShared(target)) {
+            target = CloneChunk(*target);
+        }
+        return *target;
+    }
+
+    [[no_unique_address]] Allocator alloc_;
+    std::shared_ptr<Directory> chunks_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+// Стратегии роста вместимости вектора. Стратегия вызывается, когда для required элементов
+// не хватает текущей вместимости capacity, и возвращает новую вместимость (не меньше required):
+//     static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept;
+// Без constexpr стратегия работает, но вектор с ней нельзя использовать при вычислении на этапе компиляции
+
+// Геометрический рост: новая вместимость в Numerator / Denominator раз больше текущей
+template <size_t Numerator, size_t Denominator = 1>
+struct GrowthFactor {
+    static_assert(Denominator > 0 && Numerator > Denominator, "Growth factor must be greater than 1");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        if (capacity == 0) {
+            return std::max<size_t>(required, 1);
+        }
+        constexpr size_t kMax = std::numeric_limits<size_t>::max();
+        const size_t grown = capacity > kMax / Numerator ? kMax : capacity / Denominator * Numerator
+            + capacity % Denominator * Numerator / Denominator;
+        return std::max(grown, required);
+    }
+};
+
+using DoublingGrowth = GrowthFactor<2>;
+using OneAndHalfGrowth = GrowthFactor<3, 2>;
+
+// Сразу выделяет не меньше MinCapacity элементов, избегая цепочки перевыделений 1, 2, 4...
+// на маленьких векторах. Дальше растёт по стратегии Base
+template <size_t MinCapacity, typename Base = DoublingGrowth>
+struct MinInitialCapacity {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        return std::max(Base::NextCapacity(capacity, required, element_size), MinCapacity);
+    }
+};
+
+// Округляет размер блока, который предложила стратегия Base, вверх до ближайшего класса
+// размеров типичного аллокатора (jemalloc, tcmalloc): кратно 16 байтам до 128 байт,
+// дальше по четыре класса на каждую степень двойки. Хвост блока, который аллокатор
+// всё равно отдал бы вектору, становится его вместимостью
+template <typename Base = DoublingGrowth>
+struct SizeClassRounding {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t next = Base::NextCapacity(capacity, required, element_size);
+        if (next > std::numeric_limits<size_t>::max() / 2 / element_size) {
+            return next;
+        }
+        return RoundUpToSizeClass(next * element_size) / element_size;
+    }
+
+    static constexpr size_t RoundUpToSizeClass(size_t bytes) noexcept {
+        constexpr size_t kQuantum = 16;
+        constexpr size_t kSmallLimit = 128;
+        if (bytes <= kSmallLimit) {
+            return (bytes + kQuantum - 1) / kQuantum * kQuantum;
+        }
+        size_t power = kSmallLimit;
+        while (power * 2 < bytes) {
+            power *= 2;
+        }
+        const size_t spacing = power / 4;
+        return (bytes + spacing - 1) / spacing * spacing;
+    }
+};
+
+// Растёт по стратегии Base, пока буфер меньше ThresholdBytes, а дальше линейно,
+// добавляя по StepBytes. Ограничивает неиспользуемый хвост огромных векторов
+template <size_t ThresholdBytes, size_t StepBytes, typename Base = DoublingGrowth>
+struct CappedLinearGrowth {
+    static_assert(StepBytes > 0, "Linear growth step must be positive");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        if (capacity < ThresholdBytes / element_size) {
+            return std::min(Base::NextCapacity(capacity, required, element_size),
+                            std::max(required, ThresholdBytes / element_size));
+        }
+        const size_t step = std::max<size_t>(StepBytes / element_size, 1);
+        return std::max(capacity + step, required);
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// Защищённый режим векторов. Включается макросом ADVANCED_VECTOR_HARDENED, заданным до
+// подключения vector.h (например, -DADVANCED_VECTOR_HARDENED), и должен быть одинаковым во всех
+// единицах трансляции программы. В этом режиме:
+//     - проверки индексов и итераторов, аргументов Emplace, Insert и Erase не отключаются
+//       NDEBUG и при нарушении завершают программу через std::abort;
+//     - итераторы Vector помнят поколение буфера, которое увеличивается при каждой смене
+//       буфера (рост, Reserve, ShrinkToFit, обмен), и обращение через итератор, полученный
+//       до смены, обнаруживается;
+//     - под AddressSanitizer неиспользуемая вместимость [Size(), Capacity()) буфера из кучи
+//       размечается как недоступная, и чтение за концом вектора сообщается как container-overflow.
+// Без макроса проверки сводятся к assert, а итераторы остаются обычными указателями
+#ifdef ADVANCED_VECTOR_HARDENED
+inline constexpr bool kVectorHardened = true;
+#define ADVANCED_VECTOR_CHECK(condition, message) \
+    ((condition) ? static_cast<void>(0) : ::detail::HardenedCheckFailed(message, __FILE__, __LINE__))
+#else
+inline constexpr bool kVectorHardened = false;
+#define ADVANCED_VECTOR_CHECK(condition, message) assert((condition) && (message))
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define ADVANCED_VECTOR_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ADVANCED_VECTOR_ASAN
+#endif
+#endif
+
+#if defined(ADVANCED_VECTOR_HARDENED) && defined(ADVANCED_VECTOR_ASAN)
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+namespace detail {
+
+[[noreturn]] inline void HardenedCheckFailed(const char* message, const char* file, int line) noexcept {
+    std::fprintf(stderr, "%s:%d: advanced-vector check failed: %s\n", file, line, message);
+    std::abort();
+}
+
+// Сообщает AddressSanitizer, что из буфера [first, last) доступна только часть [first, new_mid),
+// а прежде была доступна [first, old_mid). Вне защищённого режима или без AddressSanitizer пуста
+inline void AnnotateContiguousContainer([[maybe_unused]] const void* first, [[maybe_unused]] const void* last,
+                                        [[maybe_unused]] const void* old_mid, [[maybe_unused]] const void* new_mid) noexcept {
+#if defined(ADVANCED_VECTOR_HARDENED) && defined(ADVANCED_VECTOR_ASAN)
+    // Размечать можно только буфер, выровненный по гранулам теневой памяти
+    if (reinterpret_cast<uintptr_t>(first) % 8 == 0) {
+        __sanitizer_annotate_contiguous_container(first, last, old_mid, new_mid);
+    }
+#endif
+}
+
+// Состояние вектора Vector, которое нужно только проверкам защищённого режима. Тип зависит
+// от вектора, чтобы код проверок в его шаблоне компилировался только в защищённом режиме
+template <typename Vector, bool Enabled = kVectorHardened>
+struct HardenedState {
+    size_t generation = 0;
+    size_t mutation_depth = 0;
+};
+
+template <typename Vector>
+struct HardenedState<Vector, false> {};
+
+}  // namespace detail
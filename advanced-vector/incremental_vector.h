@@ -0,0 +1,387 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Массив с постепенным переносом элементов при росте. Когда вместимость исчерпана, выделяется
+// новый буфер, но элементы остаются в старом и переносятся в новый по MigrationStep штук
+// при каждом следующем добавлении или удалении. Так стоимость роста огромного массива
+// распределяется по операциям, а не выпадает на одну из них целиком.
+//
+// Пока идёт перенос, элементы [0, migrated_) и [old_size_, size_) лежат в новом буфере,
+// а [migrated_, old_size_) - ещё в старом, поэтому массив не непрерывен. Его итераторы
+// хранят индекс, а непрерывные участки можно обойти через ForEachChunk.
+// Перенос не должен выбрасывать исключений, поэтому T обязан перемещаться без исключений.
+//
+// GrowthPolicy выбирает новую вместимость, как и в BasicVector (см. growth_policy.h). Перенос
+// успевает закончиться до следующего роста, если новая вместимость хотя бы в 1 + 1 / MigrationStep
+// раз больше прежней. Иначе, как при линейном росте, рост сначала переносит оставшиеся элементы
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          size_t MigrationStep = 4>
+class IncrementalVector {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "IncrementalVector requires nothrow move constructible T");
+    static_assert(MigrationStep > 0, "MigrationStep must be positive");
+
+    using Buffer = RawMemory<T, Allocator>;
+
+    template <bool IsConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<IsConst, const IncrementalVector, IncrementalVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) noexcept  // NOLINT(google-explicit-constructor)
+            : owner_(other.owner_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator copy = *this;
+            --index_;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class BasicIterator<!IsConst>;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using allocator_type = Allocator;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    IncrementalVector() = default;
+
+    explicit IncrementalVector(const Allocator& alloc) noexcept
+        : data_(alloc)
+        , old_(alloc) {
+    }
+
+    IncrementalVector(const IncrementalVector& other)
+        : IncrementalVector(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.GetAllocator())) {
+        data_ = Buffer(other.size_, data_.GetAllocator());
+        other.ForEachChunk([this](const T* first, size_t count) {
+            std::uninitialized_copy_n(first, count, data_ + size_);
+            size_ += count;
+        });
+    }
+
+    IncrementalVector(IncrementalVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , old_(std::move(other.old_))
+        , size_(std::exchange(other.size_, 0))
+        , migrated_(std::exchange(other.migrated_, 0))
+        , old_size_(std::exchange(other.old_size_, 0)) {
+    }
+
+    IncrementalVector& operator=(const IncrementalVector& rhs) {
+        if (this != &rhs) {
+            IncrementalVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~IncrementalVector() {
+        Clear();
+    }
+
+    void Swap(IncrementalVector& other) noexcept {
+        data_.Swap(other.data_);
+        old_.Swap(other.old_);
+        std::swap(size_, other.size_);
+        std::swap(migrated_, other.migrated_);
+        std::swap(old_size_, other.old_size_);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == data_.Capacity()) {
+            StartGrowth(GrowthPolicy::NextCapacity(data_.Capacity(), size_ + 1, sizeof(T)));
+        }
+        // Аргументы могут ссылаться на ещё не перенесённые элементы,
+        // поэтому перенос выполняется только после создания нового элемента
+        T* slot = new (data_ + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        Migrate(MigrationStep);
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(&At(size_));
+        if (size_ < old_size_) {
+            old_size_ = size_;
+            if (migrated_ >= old_size_) {
+                FinishMigration();
+                return;
+            }
+        }
+        Migrate(MigrationStep);
+    }
+
+    void Clear() noexcept {
+        ForEachChunk([](T* first, size_t count) {
+            std::destroy_n(first, count);
+        });
+        size_ = 0;
+        migrated_ = old_size_ = 0;
+        Buffer empty(data_.GetAllocator());
+        old_.Swap(empty);
+    }
+
+    // Выделяет память под capacity элементов, завершая начатый перенос
+    void Reserve(size_t capacity) {
+        if (capacity <= data_.Capacity()) {
+            return;
+        }
+        StartGrowth(capacity);
+        FinishMigration();
+    }
+
+    // Переносит не больше count элементов из старого буфера
+    void Migrate(size_t count) noexcept {
+        if (!IsMigrating()) {
+            return;
+        }
+        count = std::min(count, old_size_ - migrated_);
+        RelocateN(old_ + migrated_, count, data_ + migrated_);
+        migrated_ += count;
+        if (migrated_ == old_size_) {
+            migrated_ = old_size_ = 0;
+            Buffer empty(old_.GetAllocator());
+            old_.Swap(empty);
+        }
+    }
+
+    // Переносит все оставшиеся элементы, после чего массив снова непрерывен
+    void FinishMigration() noexcept {
+        if (IsMigrating()) {
+            Migrate(old_size_ - migrated_);
+        }
+        else {
+            migrated_ = old_size_ = 0;
+            Buffer empty(old_.GetAllocator());
+            old_.Swap(empty);
+        }
+    }
+
+    bool IsMigrating() const noexcept {
+        return migrated_ < old_size_;
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return At(index);
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Передаёт fn(first, count) непрерывные участки элементов по порядку индексов
+    template <typename Fn>
+    void ForEachChunk(Fn&& fn) {
+        VisitChunks(*this, fn);
+    }
+
+    template <typename Fn>
+    void ForEachChunk(Fn&& fn) const {
+        VisitChunks(*this, fn);
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    // Элемент index лежит в старом буфере, только если его ещё не перенесли
+    T& At(size_t index) noexcept {
+        return index - migrated_ < old_size_ - migrated_ ? old_[index] : data_[index];
+    }
+
+    // Выделяет новый буфер; элементы текущего буфера начнут переноситься при следующих операциях
+    void StartGrowth(size_t new_capacity) {
+        Buffer new_data(new_capacity, data_.GetAllocator());
+        FinishMigration();
+        old_.Swap(data_);
+        data_.Swap(new_data);
+        old_size_ = size_;
+        migrated_ = 0;
+    }
+
+    static void RelocateN(T* from, size_t count, T* to) noexcept {
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            if (count != 0) {
+                std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), count * sizeof(T));
+            }
+        }
+        else {
+            std::uninitialized_move_n(from, count, to);
+            std::destroy_n(from, count);
+        }
+    }
+
+    template <typename Self, typename Fn>
+    static void VisitChunks(Self& self, Fn& fn) {
+        const size_t old_begin = self.IsMigrating() ? self.migrated_ : self.size_;
+        const size_t old_end = self.IsMigrating() ? self.old_size_ : self.size_;
+        if (old_begin != 0) {
+            fn(self.data_.GetAddress(), old_begin);
+        }
+        if (old_begin != old_end) {
+            fn(self.old_ + old_begin, old_end - old_begin);
+        }
+        if (old_end != self.size_) {
+            fn(self.data_ + old_end, self.size_ - old_end);
+        }
+    }
+
+    Buffer data_;
+    Buffer old_;
+    size_t size_ = 0;
+    size_t migrated_ = 0;
+    size_t old_size_ = 0;
+};
@@ -0,0 +1,246 @@
+#pragma once
+#include "memory_resource.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Политика размещения больших блоков по узлам NUMA. Значения совпадают с MPOL_* из mbind(2)
+enum class NumaPolicy {
+    kDefault = 0,     // политика потока: память берётся с узла, на котором впервые затронута страница
+    kPreferred = 1,   // по возможности с первого узла из маски
+    kBind = 2,        // только с узлов из маски
+    kInterleave = 3,  // страницы по очереди распределяются между узлами из маски
+};
+
+struct LargePageOptions {
+    // Блоки меньше порога выделяются базовым аллокатором
+    size_t threshold_bytes = size_t{ 4 } << 20;
+    // Сначала пытаться получить заранее зарезервированные страницы (MAP_HUGETLB), а при их
+    // нехватке - обычное отображение с подсказкой ядру собрать его из прозрачных больших страниц
+    bool use_hugetlb = false;
+    NumaPolicy numa_policy = NumaPolicy::kDefault;
+    // Узлы NUMA для numa_policy, по одному биту на узел
+    uint64_t numa_nodes = 0;
+
+    friend bool operator==(const LargePageOptions& lhs, const LargePageOptions& rhs) noexcept {
+        return lhs.threshold_bytes == rhs.threshold_bytes && lhs.use_hugetlb == rhs.use_hugetlb
+               && lhs.numa_policy == rhs.numa_policy && lhs.numa_nodes == rhs.numa_nodes;
+    }
+
+    friend bool operator!=(const LargePageOptions& lhs, const LargePageOptions& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+
+// Аллокатор, отображающий блоки от threshold_bytes напрямую через mmap: с выравниванием
+// по 2 МБ и подсказкой ядру использовать большие страницы, а при необходимости с привязкой
+// к узлам NUMA. Меньшие блоки, а также все блоки вне Linux выделяет Base.
+// Настройки хранятся в экземпляре, поэтому каждый вектор может выбрать свои:
+//     Vector<float, LargePageAllocator<float>> v(LargePageAllocator<float>(options));
+// Большие блоки растут через mremap, который переносит отображение без копирования данных
+template <typename T, typename Base = std::allocator<T>>
+class LargePageAllocator {
+    using BaseTraits = std::allocator_traits<Base>;
+
+public:
+    using value_type = T;
+    // Аллокаторы с разными настройками не могут освобождать память друг друга,
+    // поэтому аллокатор переходит к вектору вместе с его содержимым
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    template <typename U>
+    struct rebind {
+        using other = LargePageAllocator<U, typename BaseTraits::template rebind_alloc<U>>;
+    };
+
+    static constexpr size_t kHugePageSize = size_t{ 2 } << 20;
+    // Наибольшее число элементов, длина отображения для которых не переполняет size_t
+    static constexpr size_t kMaxCount = (SIZE_MAX - kHugePageSize) / sizeof(T);
+
+    LargePageAllocator() = default;
+
+    explicit LargePageAllocator(const LargePageOptions& options, const Base& base = Base()) noexcept
+        : base_(base)
+        , options_(options) {
+    }
+
+    template <typename U, typename OtherBase>
+    LargePageAllocator(const LargePageAllocator<U, OtherBase>& other) noexcept  // NOLINT(google-explicit-constructor)
+        : base_(other.GetBase())
+        , options_(other.GetOptions()) {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    // Большой блок занимает целое число страниц, и весь его хвост доступен вектору
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        if (n > kMaxCount) {
+            throw std::bad_array_new_length();
+        }
+        if (!IsLarge(n)) {
+            return { BaseTraits::allocate(base_, n), n };
+        }
+#if defined(__linux__)
+        const size_t length = MappingLength(n * sizeof(T));
+        void* ptr = Map(length);
+        // Отдать весь хвост можно, только если по полученной вместимости восстанавливается та же длина
+        const size_t count = length / sizeof(T);
+        return { static_cast<T*>(ptr), MappingLength(count * sizeof(T)) == length ? count : n };
+#else
+        return { BaseTraits::allocate(base_, n), n };
+#endif
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+#if defined(__linux__)
+        if (IsLarge(n)) {
+            munmap(ptr, MappingLength(n * sizeof(T)));
+            return;
+        }
+#endif
+        BaseTraits::deallocate(base_, ptr, n);
+    }
+
+    bool try_expand(T* ptr, size_t old_n, size_t new_n) noexcept {
+#if defined(__linux__)
+        if (IsLarge(old_n) && IsLarge(new_n) && new_n <= kMaxCount) {
+            const size_t old_length = MappingLength(old_n * sizeof(T));
+            const size_t new_length = MappingLength(new_n * sizeof(T));
+            if (new_length == old_length) {
+                return true;
+            }
+            if (mremap(ptr, old_length, new_length, 0) != MAP_FAILED) {
+                Advise(ptr, new_length);
+                return true;
+            }
+        }
+#else
+        (void)ptr, (void)old_n, (void)new_n;
+#endif
+        return false;
+    }
+
+    T* reallocate(T* ptr, size_t old_n, size_t new_n) noexcept {
+#if defined(__linux__)
+        if (IsLarge(old_n) && IsLarge(new_n) && new_n <= kMaxCount) {
+            const size_t old_length = MappingLength(old_n * sizeof(T));
+            const size_t new_length = MappingLength(new_n * sizeof(T));
+            void* new_ptr = mremap(ptr, old_length, new_length, MREMAP_MAYMOVE);
+            if (new_ptr != MAP_FAILED) {
+                Advise(new_ptr, new_length);
+                return static_cast<T*>(new_ptr);
+            }
+        }
+#else
+        (void)ptr, (void)old_n, (void)new_n;
+#endif
+        return nullptr;
+    }
+
+    const LargePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    const Base& GetBase() const noexcept {
+        return base_;
+    }
+
+    template <typename U, typename OtherBase>
+    bool operator==(const LargePageAllocator<U, OtherBase>& other) const noexcept {
+        return options_ == other.GetOptions() && base_ == other.GetBase();
+    }
+
+    template <typename U, typename OtherBase>
+    bool operator!=(const LargePageAllocator<U, OtherBase>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    bool IsLarge(size_t n) const noexcept {
+        return n * sizeof(T) >= options_.threshold_bytes && n != 0;
+    }
+
+#if defined(__linux__)
+    static size_t PageSize() noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+    // Блоки от 2 МБ округляются до целого числа больших страниц, остальные - до обычных
+    static size_t MappingLength(size_t bytes) noexcept {
+        const size_t granularity = bytes >= kHugePageSize ? kHugePageSize : PageSize();
+        return (bytes + granularity - 1) / granularity * granularity;
+    }
+
+    void* Map(size_t length) const {
+        void* ptr = MAP_FAILED;
+        if (options_.use_hugetlb && length % kHugePageSize == 0) {
+            ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+        if (ptr == MAP_FAILED) {
+            ptr = MapAligned(length);
+        }
+        if (ptr == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        Advise(ptr, length);
+        return ptr;
+    }
+
+    // Ядро собирает большие страницы только из выровненных по 2 МБ участков, поэтому
+    // отображение берётся с запасом и лишнее по краям снимается
+    static void* MapAligned(size_t length) noexcept {
+        if (length < kHugePageSize) {
+            return mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        const size_t reserved = length + kHugePageSize;
+        void* raw = mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return raw;
+        }
+        const auto begin = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (begin + kHugePageSize - 1) & ~(uintptr_t{ kHugePageSize } - 1);
+        if (aligned != begin) {
+            munmap(raw, aligned - begin);
+        }
+        if (const size_t tail = begin + reserved - (aligned + length); tail != 0) {
+            munmap(reinterpret_cast<void*>(aligned + length), tail);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Подсказки ядру не обязательны к исполнению: без поддержки больших страниц или NUMA
+    // память просто выделяется обычным образом
+    void Advise(void* ptr, size_t length) const noexcept {
+#if defined(MADV_HUGEPAGE)
+        if (length >= kHugePageSize) {
+            madvise(ptr, length, MADV_HUGEPAGE);
+        }
+#endif
+#if defined(SYS_mbind)
+        if (options_.numa_policy != NumaPolicy::kDefault && options_.numa_nodes != 0) {
+            // Системный вызов напрямую, чтобы не зависеть от libnuma. Ядро считает maxnode
+            // на единицу больше числа узлов в маске
+            const unsigned long nodes = static_cast<unsigned long>(options_.numa_nodes);
+            syscall(SYS_mbind, ptr, length, static_cast<int>(options_.numa_policy), &nodes, sizeof(nodes) * 8 + 1, 0);
+        }
+#endif
+    }
+#endif
+
+    [[no_unique_address]] Base base_;
+    LargePageOptions options_;
+};
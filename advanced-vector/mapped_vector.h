@@ -0,0 +1,449 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Отпечаток типа элементов, который записывается в файл и проверяется при открытии.
+// По умолчанию зависит от размера, выравнивания и имени типа в typeid, которое может
+// различаться между компиляторами. Специализация задаёт отпечаток, не зависящий от сборки:
+//     template <> struct MappedTypeFingerprint<Row> { static uint64_t Get() noexcept { return 42; } };
+template <typename T>
+struct MappedTypeFingerprint {
+    static uint64_t Get() noexcept {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](uint64_t byte) {
+            hash = (hash ^ byte) * 1099511628211ull;
+        };
+        for (const char* name = typeid(T).name(); *name != '\0'; ++name) {
+            mix(static_cast<unsigned char>(*name));
+        }
+        for (int shift = 0; shift < 64; shift += 8) {
+            mix((sizeof(T) >> shift) & 0xFF);
+            mix((alignof(T) >> shift) & 0xFF);
+        }
+        return hash;
+    }
+};
+
+enum class MappedMode {
+    // Изменения и рост попадают в файл
+    kReadWrite,
+    // Изменения видны только этому объекту, файл остаётся прежним
+    kCopyOnWrite,
+};
+
+template <typename T>
+class MappedVectorView;
+
+// Массив тривиально копируемых элементов, хранящийся в отображённом в память файле.
+// Файл начинается с заголовка (сигнатура, версия формата, отпечаток типа, размер и
+// вместимость), за которым лежат сами элементы. Открытие файла ничего не копирует:
+// страницы подгружаются ядром при первом обращении.
+//
+// В режиме kReadWrite рост увеличивает файл через ftruncate и расширяет отображение
+// через mremap. В режиме kCopyOnWrite файл не меняется, поэтому при росте элементы
+// переносятся в анонимную память. Ошибки системных вызовов выбрасываются как std::system_error,
+// файл неподходящего формата - как std::runtime_error.
+//
+// Файл, который нельзя менять, открывается через MappedVectorView: у него есть только
+// константный доступ, поэтому запись в защищённые страницы не компилируется
+template <typename T>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector requires trivially copyable T");
+
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t data_offset;
+        uint64_t fingerprint;
+        uint64_t size;
+        uint64_t capacity;
+    };
+
+    static constexpr uint64_t kMagic = 0x524556504D564441ull;  // "ADVMPVER"
+    static constexpr uint32_t kVersion = 1;
+    // Элементы начинаются с границы кэш-линии
+    static constexpr size_t kDataAlignment = std::max<size_t>(64, alignof(T));
+    static constexpr size_t kDataOffset = (sizeof(Header) + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Создаёт пустой файл (или очищает существующий) и открывает его в режиме kReadWrite
+    static MappedVector Create(const std::string& path, size_t capacity = 0) {
+        MappedVector result;
+        result.mode_ = MappedMode::kReadWrite;
+        result.fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (result.fd_ < 0) {
+            ThrowSystemError("open");
+        }
+        result.length_ = MappingLength(capacity);
+        if (ftruncate(result.fd_, static_cast<off_t>(result.length_)) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+        result.Map();
+        Header& header = result.GetHeader();
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.data_offset = static_cast<uint32_t>(kDataOffset);
+        header.fingerprint = MappedTypeFingerprint<T>::Get();
+        header.size = 0;
+        header.capacity = CapacityOf(result.length_);
+        return result;
+    }
+
+    // Открывает существующий файл, проверяя его заголовок
+    static MappedVector Open(const std::string& path, MappedMode mode) {
+        return OpenFile(path, mode, true);
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : mapping_(std::exchange(other.mapping_, nullptr))
+        , length_(std::exchange(other.length_, 0))
+        , fd_(std::exchange(other.fd_, -1))
+        , mode_(other.mode_)
+        , writable_(other.writable_) {
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~MappedVector() {
+        if (mapping_ != nullptr) {
+            munmap(mapping_, length_);
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    void Swap(MappedVector& other) noexcept {
+        std::swap(mapping_, other.mapping_);
+        std::swap(length_, other.length_);
+        std::swap(fd_, other.fd_);
+        std::swap(mode_, other.mode_);
+        std::swap(writable_, other.writable_);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t size = Size();
+        T* slot = nullptr;
+        if (size == Capacity()) {
+            // Аргументы могут ссылаться на элементы массива, а рост может перенести отображение
+            T value(std::forward<Args>(args)...);
+            Grow(size == 0 ? 1 : size * 2);
+            slot = new (Data() + size) T(value);
+        }
+        else {
+            slot = new (Data() + size) T(std::forward<Args>(args)...);
+        }
+        GetHeader().size = size + 1;
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PopBack() {
+        assert(Size() > 0);
+        --GetHeader().size;
+    }
+
+    // Элементы тривиально копируемы, поэтому сдвигаются одним memmove
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t index = static_cast<size_t>(pos - cbegin());
+        const size_t size = Size();
+        // Аргументы могут ссылаться на сдвигаемые элементы
+        T value(std::forward<Args>(args)...);
+        if (size == Capacity()) {
+            Grow(size == 0 ? 1 : size * 2);
+        }
+        std::memmove(Data() + index + 1, Data() + index, (size - index) * sizeof(T));
+        new (Data() + index) T(value);
+        GetHeader().size = size + 1;
+        return Data() + index;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Erase(const_iterator pos) noexcept {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) noexcept {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t index = static_cast<size_t>(first - cbegin());
+        const size_t count = static_cast<size_t>(last - first);
+        std::memmove(Data() + index, Data() + index + count, (Size() - index - count) * sizeof(T));
+        GetHeader().size = Size() - count;
+        return Data() + index;
+    }
+
+    // Новые элементы инициализируются значением по умолчанию
+    void Resize(size_t new_size) {
+        const size_t size = Size();
+        if (new_size > Capacity()) {
+            Grow(std::max(new_size, Capacity() * 2));
+        }
+        if (new_size > size) {
+            std::uninitialized_value_construct_n(Data() + size, new_size - size);
+        }
+        GetHeader().size = new_size;
+    }
+
+    void Reserve(size_t capacity) {
+        if (capacity > Capacity()) {
+            Grow(capacity);
+        }
+    }
+
+    void Clear() {
+        GetHeader().size = 0;
+    }
+
+    // Синхронно записывает изменения на диск. В остальных режимах и у перемещённого
+    // объекта ничего не делает
+    void Flush() {
+        if (mapping_ != nullptr && mode_ == MappedMode::kReadWrite && msync(mapping_, length_, MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        return const_cast<T&>(std::as_const(*this)[index]);
+    }
+
+    size_t Size() const noexcept {
+        return mapping_ != nullptr ? static_cast<size_t>(GetHeader().size) : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return mapping_ != nullptr ? static_cast<size_t>(GetHeader().capacity) : 0;
+    }
+
+    MappedMode GetMode() const noexcept {
+        return mode_;
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + Size();
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    friend class MappedVectorView<T>;
+
+    MappedVector() = default;
+
+    // Отображение только для чтения создаёт MappedVectorView, который не даёт его изменить
+    static MappedVector OpenFile(const std::string& path, MappedMode mode, bool writable) {
+        MappedVector result;
+        result.mode_ = mode;
+        result.writable_ = writable;
+        const int access = mode == MappedMode::kReadWrite && writable ? O_RDWR : O_RDONLY;
+        result.fd_ = open(path.c_str(), access | O_CLOEXEC);
+        if (result.fd_ < 0) {
+            ThrowSystemError("open");
+        }
+        struct stat file_stat {};
+        if (fstat(result.fd_, &file_stat) != 0) {
+            ThrowSystemError("fstat");
+        }
+        result.length_ = static_cast<size_t>(file_stat.st_size);
+        if (result.length_ < kDataOffset) {
+            throw std::runtime_error("MappedVector: file is too small");
+        }
+        result.Map();
+        const Header& header = result.GetHeader();
+        if (header.magic != kMagic || header.version != kVersion || header.data_offset != kDataOffset) {
+            throw std::runtime_error("MappedVector: unsupported file format");
+        }
+        if (header.fingerprint != MappedTypeFingerprint<T>::Get()) {
+            throw std::runtime_error("MappedVector: element type mismatch");
+        }
+        if (header.size > header.capacity || header.capacity > CapacityOf(result.length_)) {
+            throw std::runtime_error("MappedVector: corrupted header");
+        }
+        return result;
+    }
+
+
+    [[noreturn]] static void ThrowSystemError(const char* call) {
+        throw std::system_error(errno, std::generic_category(), std::string("MappedVector: ") + call);
+    }
+
+    static size_t PageSize() noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+    // Длина файла под capacity элементов с заголовком, округлённая до целого числа страниц
+    static size_t MappingLength(size_t capacity) {
+        if (capacity > (SIZE_MAX - kDataOffset) / sizeof(T) - PageSize()) {
+            throw std::length_error("MappedVector: capacity is too large");
+        }
+        const size_t bytes = kDataOffset + capacity * sizeof(T);
+        return (bytes + PageSize() - 1) / PageSize() * PageSize();
+    }
+
+    // Вместимость отображения длины length, включая хвост последней страницы
+    static size_t CapacityOf(size_t length) noexcept {
+        return (length - kDataOffset) / sizeof(T);
+    }
+
+    void Map() {
+        const int protection = writable_ ? PROT_READ | PROT_WRITE : PROT_READ;
+        const int flags = mode_ == MappedMode::kReadWrite ? MAP_SHARED : MAP_PRIVATE;
+        void* mapping = mmap(nullptr, length_, protection, flags, fd_, 0);
+        if (mapping == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        mapping_ = mapping;
+    }
+
+    void Grow(size_t new_capacity) {
+        const size_t new_length = MappingLength(new_capacity);
+        if (mode_ == MappedMode::kReadWrite) {
+            if (ftruncate(fd_, static_cast<off_t>(new_length)) != 0) {
+                ThrowSystemError("ftruncate");
+            }
+            void* mapping = mremap(mapping_, length_, new_length, MREMAP_MAYMOVE);
+            if (mapping == MAP_FAILED) {
+                const int error = errno;
+                // Возвращаем файлу прежний размер, чтобы он соответствовал заголовку
+                (void)ftruncate(fd_, static_cast<off_t>(length_));
+                errno = error;
+                ThrowSystemError("mremap");
+            }
+            mapping_ = mapping;
+        }
+        else {
+            // Закрытое отображение нельзя продолжить за конец файла, поэтому переносим
+            // заголовок и элементы в анонимную память
+            void* mapping = mmap(nullptr, new_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            std::memcpy(mapping, mapping_, kDataOffset + Size() * sizeof(T));
+            munmap(mapping_, length_);
+            mapping_ = mapping;
+        }
+        length_ = new_length;
+        GetHeader().capacity = CapacityOf(new_length);
+    }
+
+    Header& GetHeader() noexcept {
+        return *static_cast<Header*>(mapping_);
+    }
+
+    const Header& GetHeader() const noexcept {
+        return *static_cast<const Header*>(mapping_);
+    }
+
+    T* Data() noexcept {
+        return reinterpret_cast<T*>(static_cast<char*>(mapping_) + kDataOffset);
+    }
+
+    const T* Data() const noexcept {
+        return reinterpret_cast<const T*>(static_cast<const char*>(mapping_) + kDataOffset);
+    }
+
+    void* mapping_ = nullptr;
+    size_t length_ = 0;
+    int fd_ = -1;
+    MappedMode mode_ = MappedMode::kReadWrite;
+    bool writable_ = true;
+};
+
+// Отображённый в память файл MappedVector, открытый только для чтения. Страницы такого
+// отображения защищены от записи, поэтому вид даёт лишь константный доступ к элементам
+template <typename T>
+class MappedVectorView {
+public:
+    using iterator = const T*;
+    using const_iterator = const T*;
+
+    // Открывает существующий файл, проверяя его заголовок
+    static MappedVectorView Open(const std::string& path) {
+        return MappedVectorView(MappedVector<T>::OpenFile(path, MappedMode::kCopyOnWrite, false));
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return vector_[index];
+    }
+
+    size_t Size() const noexcept {
+        return vector_.Size();
+    }
+
+    const_iterator begin() const noexcept {
+        return vector_.begin();
+    }
+    const_iterator end() const noexcept {
+        return vector_.end();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    explicit MappedVectorView(MappedVector<T> vector) noexcept
+        : vector_(std::move(vector)) {
+    }
+
+    MappedVector<T> vector_;
+};
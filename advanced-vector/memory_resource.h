@@ -0,0 +1,556 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Результат выделения памяти с указанием реально полученного количества элементов
+// (аналог std::allocation_result из C++23)
+template <typename Pointer>
+struct AllocationResult {
+    Pointer ptr;
+    size_t count;
+};
+
+// Источник сырой памяти в духе std::pmr::memory_resource. Векторы получают к нему доступ
+// через ResourceAllocator, поэтому один ресурс могут разделять векторы разных типов
+class MemoryResource {
+public:
+    virtual ~MemoryResource() = default;
+
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        return DoAllocate(bytes, alignment);
+    }
+
+    // Выделяет не меньше bytes байт и сообщает, сколько памяти получено на самом деле.
+    // Освобождать блок можно, указав как запрошенный, так и полученный размер
+    AllocationResult<void*> AllocateAtLeast(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        return DoAllocateAtLeast(bytes, alignment);
+    }
+
+    void Deallocate(void* ptr, size_t bytes, size_t alignment = alignof(std::max_align_t)) noexcept {
+        DoDeallocate(ptr, bytes, alignment);
+    }
+
+    // Пытается увеличить на месте блок ptr размера old_bytes до new_bytes байт.
+    // При неудаче блок остаётся прежним
+    bool TryExpand(void* ptr, size_t old_bytes, size_t new_bytes) noexcept {
+        return DoTryExpand(ptr, old_bytes, new_bytes);
+    }
+
+    // Ресурсы равны, если память, выделенную одним из них, может освободить другой
+    bool IsEqual(const MemoryResource& other) const noexcept {
+        return this == &other || DoIsEqual(other);
+    }
+
+private:
+    virtual void* DoAllocate(size_t bytes, size_t alignment) = 0;
+    virtual void DoDeallocate(void* ptr, size_t bytes, size_t alignment) noexcept = 0;
+
+    virtual AllocationResult<void*> DoAllocateAtLeast(size_t bytes, size_t alignment) {
+        return { DoAllocate(bytes, alignment), bytes };
+    }
+
+    virtual bool DoTryExpand(void* /*ptr*/, size_t /*old_bytes*/, size_t /*new_bytes*/) noexcept {
+        return false;
+    }
+
+    virtual bool DoIsEqual(const MemoryResource& /*other*/) const noexcept {
+        return false;
+    }
+};
+
+// Ресурс, обращающийся к глобальным operator new и operator delete
+class NewDeleteResource final : public MemoryResource {
+private:
+    void* DoAllocate(size_t bytes, size_t alignment) override {
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return operator new(bytes, std::align_val_t{ alignment });
+        }
+        return operator new(bytes);
+    }
+
+    void DoDeallocate(void* ptr, size_t /*bytes*/, size_t alignment) noexcept override {
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            operator delete(ptr, std::align_val_t{ alignment });
+        }
+        else {
+            operator delete(ptr);
+        }
+    }
+
+    bool DoIsEqual(const MemoryResource& other) const noexcept override {
+        return dynamic_cast<const NewDeleteResource*>(&other) != nullptr;
+    }
+};
+
+inline MemoryResource* GetNewDeleteResource() noexcept {
+    static NewDeleteResource resource;
+    return &resource;
+}
+
+// Монотонный (bump) ресурс: выделение памяти сводится к сдвигу указателя внутри текущего блока,
+// а освобождается память только целиком, вызовом Release или в деструкторе.
+// Ресурс не синхронизирован и рассчитан на использование в пределах одного потока,
+// например, для всех векторов, созданных при обработке одного запроса
+class ArenaResource final : public MemoryResource {
+public:
+    explicit ArenaResource(MemoryResource* upstream = GetNewDeleteResource()) noexcept
+        : upstream_(upstream) {
+    }
+
+    explicit ArenaResource(size_t initial_block_size, MemoryResource* upstream = GetNewDeleteResource()) noexcept
+        : upstream_(upstream)
+        , next_block_size_(std::max(initial_block_size, kMinBlockSize)) {
+    }
+
+    // Начинает выделение с переданного буфера (например, на стеке). Буфер не освобождается ресурсом
+    ArenaResource(void* buffer, size_t size, MemoryResource* upstream = GetNewDeleteResource()) noexcept
+        : upstream_(upstream)
+        , initial_buffer_(static_cast<std::byte*>(buffer))
+        , initial_size_(size)
+        , current_(initial_buffer_)
+        , end_(initial_buffer_ + size) {
+    }
+
+    ArenaResource(const ArenaResource&) = delete;
+    ArenaResource& operator=(const ArenaResource&) = delete;
+
+    ~ArenaResource() {
+        Release();
+    }
+
+    // Возвращает вышестоящему ресурсу все блоки. Указатели, полученные от арены, становятся недействительными
+    void Release() noexcept {
+        while (blocks_ != nullptr) {
+            BlockHeader* next = blocks_->next;
+            upstream_->Deallocate(blocks_, blocks_->size, alignof(BlockHeader));
+            blocks_ = next;
+        }
+        current_ = initial_buffer_;
+        end_ = initial_buffer_ + initial_size_;
+        last_allocation_ = nullptr;
+    }
+
+    MemoryResource* GetUpstream() const noexcept {
+        return upstream_;
+    }
+
+private:
+    struct alignas(std::max_align_t) BlockHeader {
+        BlockHeader* next;
+        size_t size;
+    };
+
+    static constexpr size_t kMinBlockSize = 1024;
+
+    void* DoAllocate(size_t bytes, size_t alignment) override {
+        std::byte* result = AlignUp(current_, alignment);
+        // Выравнивание может увести результат за конец блока, и тогда разность отрицательна
+        if (result == nullptr || result > end_ || static_cast<size_t>(end_ - result) < bytes) {
+            AddBlock(bytes + alignment);
+            result = AlignUp(current_, alignment);
+        }
+        current_ = result + bytes;
+        last_allocation_ = result;
+        return result;
+    }
+
+    void DoDeallocate(void* ptr, size_t bytes, size_t /*alignment*/) noexcept override {
+        // Освобождение последнего выделенного блока откатывает указатель, остальные вызовы ничего не делают
+        if (ptr == last_allocation_ && static_cast<std::byte*>(ptr) + bytes == current_) {
+            current_ = last_allocation_;
+            last_allocation_ = nullptr;
+        }
+    }
+
+    // Последний выделенный блок можно нарастить, пока в текущем блоке арены хватает места
+    bool DoTryExpand(void* ptr, size_t old_bytes, size_t new_bytes) noexcept override {
+        auto* block = static_cast<std::byte*>(ptr);
+        if (block != last_allocation_ || block + old_bytes != current_ || block > end_
+            || static_cast<size_t>(end_ - block) < new_bytes) {
+            return false;
+        }
+        current_ = block + new_bytes;
+        return true;
+    }
+
+    static std::byte* AlignUp(std::byte* ptr, size_t alignment) noexcept {
+        if (ptr == nullptr) {
+            return nullptr;
+        }
+        const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        const auto aligned = (address + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+        return ptr + (aligned - address);
+    }
+
+    void AddBlock(size_t min_payload) {
+        const size_t size = std::max(next_block_size_, min_payload + sizeof(BlockHeader));
+        void* memory = upstream_->Allocate(size, alignof(BlockHeader));
+        blocks_ = new (memory) BlockHeader{ blocks_, size };
+        current_ = reinterpret_cast<std::byte*>(blocks_ + 1);
+        end_ = static_cast<std::byte*>(memory) + size;
+        next_block_size_ = size * 2;
+    }
+
+    MemoryResource* upstream_;
+    std::byte* initial_buffer_ = nullptr;
+    size_t initial_size_ = 0;
+    std::byte* current_ = nullptr;
+    std::byte* end_ = nullptr;
+    std::byte* last_allocation_ = nullptr;
+    BlockHeader* blocks_ = nullptr;
+    size_t next_block_size_ = kMinBlockSize;
+};
+
+// Ресурс с пулами блоков фиксированных размеров (8, 16, 32 ... kMaxPooledSize байт).
+// Освобождённые блоки попадают в список свободных блоков своего класса и повторно
+// используются без обращения к вышестоящему ресурсу. Запросы крупнее kMaxPooledSize
+// передаются вышестоящему ресурсу напрямую. Release возвращает всю память разом.
+// Как и ArenaResource, ресурс не синхронизирован
+class PoolResource final : public MemoryResource {
+public:
+    static constexpr size_t kMinPooledSize = 8;
+    static constexpr size_t kMaxPooledSize = 4096;
+
+    explicit PoolResource(MemoryResource* upstream = GetNewDeleteResource()) noexcept
+        : upstream_(upstream) {
+    }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    ~PoolResource() {
+        Release();
+    }
+
+    void Release() noexcept {
+        while (chunks_ != nullptr) {
+            ChunkHeader* next = chunks_->next;
+            upstream_->Deallocate(chunks_, chunks_->size, alignof(ChunkHeader));
+            chunks_ = next;
+        }
+        while (large_ != nullptr) {
+            LargeHeader* next = large_->next;
+            upstream_->Deallocate(LargeMemory(large_), large_->size, large_->alignment);
+            large_ = next;
+        }
+        for (auto& pool : pools_) {
+            pool = Pool{};
+        }
+    }
+
+    MemoryResource* GetUpstream() const noexcept {
+        return upstream_;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct alignas(std::max_align_t) ChunkHeader {
+        ChunkHeader* next;
+        size_t size;
+    };
+
+    // Заголовок, который предшествует каждому крупному блоку и связывает их в двусвязный список
+    struct alignas(std::max_align_t) LargeHeader {
+        LargeHeader* prev;
+        LargeHeader* next;
+        size_t size;
+        size_t alignment;
+    };
+
+    struct Pool {
+        FreeBlock* free_list = nullptr;
+        size_t blocks_per_chunk = 16;
+    };
+
+    static constexpr size_t kPoolCount = 10;  // 8 << 9 == 4096
+    static constexpr size_t kMaxBlocksPerChunk = 1024;
+
+    static size_t PoolIndex(size_t bytes) noexcept {
+        size_t index = 0;
+        for (size_t block_size = kMinPooledSize; block_size < bytes; block_size *= 2) {
+            ++index;
+        }
+        return index;
+    }
+
+    static size_t BlockSize(size_t index) noexcept {
+        return kMinPooledSize << index;
+    }
+
+    static bool IsPooled(size_t bytes, size_t alignment) noexcept {
+        return bytes <= kMaxPooledSize && alignment <= alignof(std::max_align_t);
+    }
+
+    void* DoAllocate(size_t bytes, size_t alignment) override {
+        if (!IsPooled(bytes, alignment)) {
+            return AllocateLarge(bytes, alignment);
+        }
+        const size_t index = PoolIndex(bytes);
+        Pool& pool = pools_[index];
+        if (pool.free_list == nullptr) {
+            Refill(index);
+        }
+        FreeBlock* block = pool.free_list;
+        pool.free_list = block->next;
+        return block;
+    }
+
+    // Блок из пула имеет размер своего класса, и весь этот размер можно использовать
+    AllocationResult<void*> DoAllocateAtLeast(size_t bytes, size_t alignment) override {
+        void* ptr = DoAllocate(bytes, alignment);
+        return { ptr, IsPooled(bytes, alignment) ? BlockSize(PoolIndex(bytes)) : bytes };
+    }
+
+    void DoDeallocate(void* ptr, size_t bytes, size_t alignment) noexcept override {
+        if (!IsPooled(bytes, alignment)) {
+            DeallocateLarge(ptr);
+            return;
+        }
+        Pool& pool = pools_[PoolIndex(bytes)];
+        pool.free_list = new (ptr) FreeBlock{ pool.free_list };
+    }
+
+    // Добавляет в пул index новый участок памяти, нарезанный на блоки.
+    // Размер следующего участка удваивается, пока не достигнет kMaxBlocksPerChunk блоков
+    void Refill(size_t index) {
+        Pool& pool = pools_[index];
+        const size_t block_size = BlockSize(index);
+        const size_t size = sizeof(ChunkHeader) + block_size * pool.blocks_per_chunk;
+        void* memory = upstream_->Allocate(size, alignof(ChunkHeader));
+        chunks_ = new (memory) ChunkHeader{ chunks_, size };
+
+        std::byte* first = reinterpret_cast<std::byte*>(chunks_ + 1);
+        for (size_t i = pool.blocks_per_chunk; i != 0; --i) {
+            pool.free_list = new (first + (i - 1) * block_size) FreeBlock{ pool.free_list };
+        }
+        pool.blocks_per_chunk = std::min(pool.blocks_per_chunk * 2, kMaxBlocksPerChunk);
+    }
+
+    static size_t LargeOffset(size_t alignment) noexcept {
+        return std::max(sizeof(LargeHeader), alignment);
+    }
+
+    // Начало блока, полученного от вышестоящего ресурса, которому принадлежит заголовок header
+    static void* LargeMemory(LargeHeader* header) noexcept {
+        return reinterpret_cast<std::byte*>(header + 1) - LargeOffset(header->alignment);
+    }
+
+    void* AllocateLarge(size_t bytes, size_t alignment) {
+        alignment = std::max(alignment, alignof(LargeHeader));
+        const size_t offset = LargeOffset(alignment);
+        const size_t size = offset + bytes;
+        std::byte* memory = static_cast<std::byte*>(upstream_->Allocate(size, alignment));
+        auto* header = new (memory + offset - sizeof(LargeHeader)) LargeHeader{ nullptr, large_, size, alignment };
+        if (large_ != nullptr) {
+            large_->prev = header;
+        }
+        large_ = header;
+        return memory + offset;
+    }
+
+    void DeallocateLarge(void* ptr) noexcept {
+        auto* header = reinterpret_cast<LargeHeader*>(static_cast<std::byte*>(ptr) - sizeof(LargeHeader));
+        if (header->prev != nullptr) {
+            header->prev->next = header->next;
+        }
+        else {
+            large_ = header->next;
+        }
+        if (header->next != nullptr) {
+            header->next->prev = header->prev;
+        }
+        upstream_->Deallocate(LargeMemory(header), header->size, header->alignment);
+    }
+
+    MemoryResource* upstream_;
+    Pool pools_[kPoolCount];
+    ChunkHeader* chunks_ = nullptr;
+    LargeHeader* large_ = nullptr;
+};
+
+// Аллокатор, получающий память у MemoryResource. Как и std::pmr::polymorphic_allocator,
+// не передаётся при присваивании и обмене контейнеров, а копия контейнера по умолчанию
+// использует GetNewDeleteResource
+template <typename T>
+class ResourceAllocator {
+public:
+    using value_type = T;
+
+    ResourceAllocator() noexcept = default;
+
+    ResourceAllocator(MemoryResource* resource) noexcept  // NOLINT(google-explicit-constructor)
+        : resource_(resource) {
+        assert(resource_ != nullptr);
+    }
+
+    template <typename U>
+    ResourceAllocator(const ResourceAllocator<U>& other) noexcept  // NOLINT(google-explicit-constructor)
+        : resource_(other.GetResource()) {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(resource_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        const auto result = resource_->AllocateAtLeast(n * sizeof(T), alignof(T));
+        return { static_cast<T*>(result.ptr), result.count / sizeof(T) };
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        resource_->Deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    bool try_expand(T* ptr, size_t old_n, size_t new_n) noexcept {
+        return resource_->TryExpand(ptr, old_n * sizeof(T), new_n * sizeof(T));
+    }
+
+    ResourceAllocator select_on_container_copy_construction() const noexcept {
+        return ResourceAllocator();
+    }
+
+    MemoryResource* GetResource() const noexcept {
+        return resource_;
+    }
+
+    template <typename U>
+    bool operator==(const ResourceAllocator<U>& other) const noexcept {
+        return resource_->IsEqual(*other.GetResource());
+    }
+
+    template <typename U>
+    bool operator!=(const ResourceAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    MemoryResource* resource_ = GetNewDeleteResource();
+};
+
+// Аллокатор поверх malloc/realloc. Для тривиально перемещаемых элементов вектор растёт через
+// realloc, который часто увеличивает блок на месте или переносит его без поэлементного копирования
+template <typename T>
+class MallocAllocator {
+public:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc can't provide alignment of T");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    MallocAllocator() noexcept = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {  // NOLINT(google-explicit-constructor)
+    }
+
+    T* allocate(size_t n) {
+        if (n > SIZE_MAX / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        if (void* ptr = std::malloc(n * sizeof(T))) {
+            return static_cast<T*>(ptr);
+        }
+        throw std::bad_alloc();
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        T* ptr = allocate(n);
+#if defined(__GLIBC__)
+        // malloc округляет запрос до своего класса размеров, и весь блок доступен для использования
+        n = malloc_usable_size(ptr) / sizeof(T);
+#endif
+        return { ptr, n };
+    }
+
+    void deallocate(T* ptr, size_t /*n*/) noexcept {
+        std::free(ptr);
+    }
+
+    T* reallocate(T* ptr, size_t /*old_n*/, size_t new_n) noexcept {
+        if (new_n > SIZE_MAX / sizeof(T)) {
+            return nullptr;
+        }
+        return static_cast<T*>(std::realloc(ptr, new_n * sizeof(T)));
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Размер кэш-линии, до которого AlignedAllocator дополняет блоки
+inline constexpr size_t kCacheLineSize = 64;
+
+// Аллокатор, выравнивающий блоки по границе Alignment (но не слабее alignof(T)) через
+// выравнивающие перегрузки operator new и operator delete. Выравнивание по kCacheLineSize
+// исключает ложное разделение кэш-линий между буферами разных потоков и позволяет векторным
+// инструкциям читать буфер выровненными блоками. При PadToCacheLine блок дополняется до целого
+// числа кэш-линий, и вектор получает весь хвост последней линии как дополнительную вместимость:
+//     Vector<float, AlignedAllocator<float, kCacheLineSize, true>> v;
+template <typename T, size_t Alignment = alignof(T), bool PadToCacheLine = false>
+class AlignedAllocator {
+public:
+    static constexpr size_t kAlignment = std::max(Alignment, alignof(T));
+    static_assert((kAlignment & (kAlignment - 1)) == 0, "Alignment must be a power of two");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment, PadToCacheLine>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, PadToCacheLine>&) noexcept {  // NOLINT(google-explicit-constructor)
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        constexpr size_t kBlock = PadToCacheLine ? std::max(kAlignment, kCacheLineSize) : 1;
+        if (n > (SIZE_MAX - kBlock) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = (n * sizeof(T) + kBlock - 1) / kBlock * kBlock;
+        void* ptr = ::operator new(bytes, std::align_val_t{ kAlignment });
+        return { static_cast<T*>(ptr), bytes / sizeof(T) };
+    }
+
+    // Память освобождается без указания размера, поэтому вместимость с хвостом передавать не обязательно
+    void deallocate(T* ptr, size_t /*n*/) noexcept {
+        ::operator delete(ptr, std::align_val_t{ kAlignment });
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment, PadToCacheLine>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment, PadToCacheLine>&) const noexcept {
+        return false;
+    }
+};
@@ -0,0 +1,280 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Исполнитель параллельных задач. Реализация может опираться на собственный пул потоков
+// приложения: векторы лишь передают ей набор независимых частей работы
+class ParallelExecutor {
+public:
+    virtual ~ParallelExecutor() = default;
+
+    // Вызывает task(i) для каждого i из [0, count) и возвращает управление, когда все вызовы
+    // завершились. Задачи не выбрасывают исключений. Если запустить задачи параллельно
+    // не удалось, Run должен выполнить их сам, а не выбрасывать исключение. Разрушение
+    // элементов вызывает Run из noexcept-функций, поэтому исключение из Run завершает программу
+    virtual void Run(size_t count, const std::function<void(size_t)>& task) = 0;
+
+    // Сколько задач имеет смысл выполнять одновременно
+    virtual size_t GetConcurrency() const noexcept = 0;
+};
+
+namespace detail {
+
+// Ждёт pred на cv без ограничения времени. condition_variable::wait в libstdc++ 12 получил новую
+// версию символа, и собранная с ним программа не запускается со старой libstdc++ - например,
+// той, что приходит вместе с библиотеками из conda. Ожидание до момента времени встраивается
+// в вызывающий код и таких требований не добавляет
+template <typename Predicate>
+void WaitUntil(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, Predicate pred) {
+    cv.wait_until(lock, std::chrono::steady_clock::time_point::max(), pred);
+}
+
+}  // namespace detail
+
+// Пул из concurrency - 1 потоков, которые создаются при первом вызове Run и ждут следующих
+// до разрушения исполнителя. Вызывающий поток выполняет задачи вместе с пулом. Пока пул занят,
+// другие вызовы Run, в том числе вложенные из задач, выполняют свои задачи сами
+class ThreadExecutor : public ParallelExecutor {
+public:
+    explicit ThreadExecutor(size_t concurrency = std::max(1u, std::thread::hardware_concurrency())) noexcept
+        : concurrency_(std::max<size_t>(concurrency, 1)) {
+    }
+
+    ThreadExecutor(const ThreadExecutor&) = delete;
+    ThreadExecutor& operator=(const ThreadExecutor&) = delete;
+
+    ~ThreadExecutor() override {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void Run(size_t count, const std::function<void(size_t)>& task) override {
+        if (count < 2 || busy_.exchange(true, std::memory_order_acquire)) {
+            RunHere(count, task);
+            return;
+        }
+        if (!StartWorkers()) {
+            busy_.store(false, std::memory_order_release);
+            RunHere(count, task);
+            return;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            task_ = &task;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            pending_ = workers_.size();
+            ++job_;
+        }
+        wake_.notify_all();
+        Work();
+        std::unique_lock lock(mutex_);
+        detail::WaitUntil(done_, lock, [this] {
+            return pending_ == 0;
+        });
+        task_ = nullptr;
+        busy_.store(false, std::memory_order_release);
+    }
+
+    size_t GetConcurrency() const noexcept override {
+        return concurrency_;
+    }
+
+private:
+    static void RunHere(size_t count, const std::function<void(size_t)>& task) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+    }
+
+    // Запускает недостающие потоки пула. Если потоков не хватило, пул работает с теми, что есть
+    bool StartWorkers() noexcept {
+        try {
+            workers_.reserve(concurrency_ - 1);
+            while (workers_.size() + 1 < concurrency_) {
+                workers_.emplace_back([this] {
+                    WorkerLoop();
+                });
+            }
+        }
+        catch (const std::exception&) {
+        }
+        return !workers_.empty();
+    }
+
+    void Work() {
+        for (size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < count_;
+             i = next_.fetch_add(1, std::memory_order_relaxed)) {
+            (*task_)(i);
+        }
+    }
+
+    void WorkerLoop() {
+        uint64_t seen = 0;
+        std::unique_lock lock(mutex_);
+        while (true) {
+            detail::WaitUntil(wake_, lock, [&] {
+                return stop_ || job_ != seen;
+            });
+            if (stop_) {
+                return;
+            }
+            seen = job_;
+            lock.unlock();
+            Work();
+            lock.lock();
+            // Run возвращает управление, только когда каждый поток пула закончил текущий вызов
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    size_t concurrency_;
+    std::atomic<bool> busy_{ false };
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    bool stop_ = false;
+    uint64_t job_ = 0;
+    size_t pending_ = 0;
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t count_ = 0;
+    std::atomic<size_t> next_{ 0 };
+};
+
+inline ParallelExecutor& GetDefaultExecutor() {
+    static ThreadExecutor executor;
+    return executor;
+}
+
+// Параметры параллельного выполнения массовых операций вектора. Диапазон делится на части
+// не меньше threshold элементов; более короткие диапазоны обрабатываются вызывающим потоком
+struct ParallelPolicy {
+    ParallelExecutor* executor = nullptr;  // nullptr - GetDefaultExecutor()
+    size_t threshold = size_t{ 1 } << 15;
+};
+
+namespace detail {
+
+inline std::atomic<const ParallelPolicy*>& DestructorPolicy() noexcept {
+    static std::atomic<const ParallelPolicy*> policy{ nullptr };
+    return policy;
+}
+
+}  // namespace detail
+
+// Задаёт политику, по которой деструкторы векторов разрушают элементы, или nullptr (по умолчанию),
+// чтобы они разрушали их в вызывающем потоке. Деструктор не принимает параметров, поэтому
+// параллельное разрушение включается для всей программы: только если деструкторы элементов
+// можно безопасно вызывать из разных потоков. Политика должна жить, пока она установлена
+inline void SetDestructorPolicy(const ParallelPolicy* policy) noexcept {
+    detail::DestructorPolicy().store(policy, std::memory_order_release);
+}
+
+inline const ParallelPolicy* GetDestructorPolicy() noexcept {
+    return detail::DestructorPolicy().load(std::memory_order_acquire);
+}
+
+namespace detail {
+
+// Разбиение диапазона на части для исполнителя
+struct ChunkPlan {
+    ParallelExecutor* executor = nullptr;
+    size_t count = 0;  // меньше двух - диапазон выгоднее обработать в вызывающем потоке
+    size_t size = 0;
+
+    size_t Offset(size_t chunk) const noexcept {
+        return chunk * size;
+    }
+
+    size_t Size(size_t chunk, size_t total) const noexcept {
+        return std::min(size, total - std::min(total, Offset(chunk)));
+    }
+};
+
+inline ChunkPlan PlanChunks(const ParallelPolicy& policy, size_t total) {
+    ChunkPlan plan;
+    plan.executor = policy.executor != nullptr ? policy.executor : &GetDefaultExecutor();
+    plan.count = std::min(plan.executor->GetConcurrency(), total / std::max<size_t>(policy.threshold, 1));
+    plan.size = plan.count > 1 ? (total + plan.count - 1) / plan.count : total;
+    // После округления размера вверх последним частям может не достаться элементов:
+    // 5 элементов на 4 части дают части по 2, и заполнены только три из них
+    plan.count = plan.count > 1 ? (total + plan.size - 1) / plan.size : plan.count;
+    return plan;
+}
+
+// Разрушает count элементов начиная с first. Задача передаётся через std::ref, поэтому
+// std::function не выделяет память. Какие части успели разрушиться, если Run всё же
+// выбросил исключение, неизвестно, и noexcept завершает программу
+template <typename T>
+void ParallelDestroy(const ParallelPolicy& policy, T* first, size_t count) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        const ChunkPlan plan = PlanChunks(policy, count);
+        if (plan.count < 2) {
+            std::destroy_n(first, count);
+            return;
+        }
+        const auto destroy_chunk = [&](size_t chunk) {
+            std::destroy_n(first + plan.Offset(chunk), plan.Size(chunk, count));
+        };
+        plan.executor->Run(plan.count, std::ref(destroy_chunk));
+    }
+}
+
+// Создаёт count элементов начиная с first вызовами construct(first + offset, offset, size),
+// каждый из которых создаёт size элементов или, выбросив исключение, не оставляет ни одного.
+// Если хоть одна часть не удалась, успешно созданные части разрушаются, а исключение
+// первой неудавшейся части пробрасывается дальше
+template <typename T, typename Construct>
+void ParallelConstruct(const ParallelPolicy& policy, T* first, size_t count, Construct construct) {
+    const ChunkPlan plan = PlanChunks(policy, count);
+    if (plan.count < 2) {
+        construct(first, 0, count);
+        return;
+    }
+    const auto constructed = std::make_unique<bool[]>(plan.count);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    plan.executor->Run(plan.count, [&](size_t chunk) {
+        try {
+            construct(first + plan.Offset(chunk), plan.Offset(chunk), plan.Size(chunk, count));
+            constructed[chunk] = true;
+        }
+        catch (...) {
+            std::lock_guard lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    });
+    if (error) {
+        for (size_t chunk = 0; chunk < plan.count; ++chunk) {
+            if (constructed[chunk]) {
+                std::destroy_n(first + plan.Offset(chunk), plan.Size(chunk, count));
+            }
+        }
+        std::rethrow_exception(error);
+    }
+}
+
+}  // namespace detail
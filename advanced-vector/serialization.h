@@ -0,0 +1,334 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+class VectorWriter;
+class VectorReader;
+
+// Кодек элементов, которые нельзя передать как сырые байты. Специализация задаёт
+//     static void Encode(VectorWriter& out, const T& value);
+//     static T Decode(VectorReader& in);
+// и пишет или читает байты через WriteBytes и ReadBytes. Другой кодек можно передать
+// шаблонным параметром VectorWriter::Write и VectorReader::Read
+template <typename T, typename = void>
+struct ElementCodec;
+
+namespace detail {
+
+// Заголовок сериализованного вектора. Сырые байты элементов пишутся в порядке байтов
+// и с раскладкой той машины, которая их записала
+struct SerializedVectorHeader {
+    static constexpr uint32_t kMagic = 0x43455641;  // "AVEC"
+    static constexpr uint16_t kVersion = 1;
+    static constexpr uint16_t kRawEncoding = 0;    // элементы - сырые байты
+    static constexpr uint16_t kCodecEncoding = 1;  // элементы закодированы ElementCodec
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t encoding;
+    uint64_t element_size;
+    uint64_t count;
+};
+
+[[noreturn]] inline void ThrowSerializationError(const char* call) {
+    throw std::system_error(errno, std::generic_category(), std::string("Vector serialization: ") + call);
+}
+
+// Linux передаёт за один вызов не больше 0x7ffff000 байт, остальное дописывается в цикле
+inline constexpr size_t kMaxTransfer = 0x7ffff000;
+
+}  // namespace detail
+
+// Поток записи векторов в файловый дескриптор. Мелкие записи кодеков копятся в буфере,
+// а большие участки - например, вся память вектора тривиально копируемых элементов -
+// уходят одним writev вместе с накопленным буфером, без промежуточного копирования.
+// Ошибки системных вызовов выбрасываются как std::system_error
+class VectorWriter {
+public:
+    static constexpr size_t kBufferSize = size_t{ 64 } << 10;
+
+    explicit VectorWriter(int fd)
+        : fd_(fd)
+        , buffer_(std::make_unique<char[]>(kBufferSize)) {
+    }
+
+    VectorWriter(const VectorWriter&) = delete;
+    VectorWriter& operator=(const VectorWriter&) = delete;
+
+    // Записывает заголовок и элементы v. Тривиально копируемые элементы пишутся
+    // сырыми байтами, остальные - по одному через Codec
+    template <typename Codec = void, typename T, typename Storage, typename GrowthPolicy>
+    void Write(const BasicVector<T, Storage, GrowthPolicy>& v) {
+        using Header = detail::SerializedVectorHeader;
+        constexpr bool kRaw = std::is_void_v<Codec> && std::is_trivially_copyable_v<T>;
+        using ElementCodecType = std::conditional_t<std::is_void_v<Codec>, ElementCodec<T>, Codec>;
+
+        const Header header{ Header::kMagic, Header::kVersion, kRaw ? Header::kRawEncoding : Header::kCodecEncoding,
+                             sizeof(T), v.Size() };
+        WriteBytes(&header, sizeof(header));
+        if constexpr (kRaw) {
+            WriteBytes(v.Data(), v.Size() * sizeof(T));
+        }
+        else {
+            for (const T& value : v) {
+                ElementCodecType::Encode(*this, value);
+            }
+        }
+    }
+
+    void WriteBytes(const void* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        if (size <= kBufferSize - buffered_) {
+            std::memcpy(buffer_.get() + buffered_, data, size);
+            buffered_ += size;
+            return;
+        }
+        iovec parts[2] = { { buffer_.get(), buffered_ }, { const_cast<void*>(data), size } };
+        WriteAll(parts, 2);
+        buffered_ = 0;
+    }
+
+    // Отправляет накопленный буфер в дескриптор
+    void Flush() {
+        iovec part{ buffer_.get(), buffered_ };
+        WriteAll(&part, 1);
+        buffered_ = 0;
+    }
+
+    ~VectorWriter() {
+        // Ошибку записи в деструкторе сообщить некому: вызывайте Flush явно
+        try {
+            Flush();
+        }
+        catch (...) {
+        }
+    }
+
+private:
+    void WriteAll(iovec* parts, int count) {
+        while (count > 0) {
+            if (parts->iov_len == 0) {
+                ++parts, --count;
+                continue;
+            }
+            const ssize_t written = writev(fd_, parts, count);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                detail::ThrowSerializationError("writev");
+            }
+            for (auto rest = static_cast<size_t>(written); rest != 0;) {
+                const size_t step = std::min(rest, parts->iov_len);
+                parts->iov_base = static_cast<char*>(parts->iov_base) + step;
+                parts->iov_len -= step;
+                rest -= step;
+                if (parts->iov_len == 0) {
+                    ++parts, --count;
+                }
+            }
+        }
+    }
+
+    int fd_;
+    std::unique_ptr<char[]> buffer_;
+    size_t buffered_ = 0;
+};
+
+// Поток чтения векторов из файлового дескриптора. Сырые байты элементов читаются прямо
+// в память вектора: readv заполняет её и заодно подкачивает в буфер начало следующих
+// данных, поэтому других чтений из того же дескриптора быть не должно.
+//
+// Память под вектор выделяется один раз по длине из заголовка. Чтобы испорченный заголовок
+// не заставил выделить память под отсутствующие данные, длина сверяется с остатком обычного
+// файла. У каналов и сокетов остаток неизвестен, и для них стоит задать max_vector_bytes -
+// наибольший размер элементов одного вектора в памяти.
+// Поток неподходящего формата или оборванный на середине выбрасывает std::runtime_error
+class VectorReader {
+public:
+    static constexpr size_t kBufferSize = size_t{ 64 } << 10;
+
+    explicit VectorReader(int fd, size_t max_vector_bytes = std::numeric_limits<size_t>::max())
+        : fd_(fd)
+        , max_vector_bytes_(max_vector_bytes)
+        , buffer_(std::make_unique<char[]>(kBufferSize)) {
+    }
+
+    VectorReader(const VectorReader&) = delete;
+    VectorReader& operator=(const VectorReader&) = delete;
+
+    // Заменяет содержимое v прочитанным вектором. При исключении v остаётся пустым
+    template <typename Codec = void, typename T, typename Storage, typename GrowthPolicy>
+    void Read(BasicVector<T, Storage, GrowthPolicy>& v) {
+        using Header = detail::SerializedVectorHeader;
+        constexpr bool kRaw = std::is_void_v<Codec> && std::is_trivially_copyable_v<T>;
+        using ElementCodecType = std::conditional_t<std::is_void_v<Codec>, ElementCodec<T>, Codec>;
+
+        v.Clear();
+        Header header{};
+        ReadBytes(&header, sizeof(header));
+        if (header.magic != Header::kMagic || header.version != Header::kVersion) {
+            throw std::runtime_error("Vector serialization: unsupported stream format");
+        }
+        if (header.encoding != (kRaw ? Header::kRawEncoding : Header::kCodecEncoding)
+            || (kRaw && header.element_size != sizeof(T))) {
+            throw std::runtime_error("Vector serialization: element type mismatch");
+        }
+        if (header.count > max_vector_bytes_ / sizeof(T)) {
+            throw std::runtime_error("Vector serialization: vector is too large");
+        }
+        const auto count = static_cast<size_t>(header.count);
+        // Каждый закодированный элемент занимает в потоке хотя бы байт, а сырой - sizeof(T) байт
+        const size_t available = AvailableBytes(kRaw ? count * sizeof(T) : count);
+        if (kRaw && count * sizeof(T) > available) {
+            throw std::runtime_error("Vector serialization: unexpected end of stream");
+        }
+        try {
+            if constexpr (kRaw) {
+                // Байты из потока читаются прямо в память вектора, без создания элементов
+                v.ResizeAndOverwrite(count, [this](T* data, size_t size) {
+                    ReadBytes(data, size * sizeof(T));
+                    return size;
+                });
+            }
+            else {
+                v.Reserve(std::min(count, available));
+                for (size_t i = 0; i < count; ++i) {
+                    v.EmplaceBack(ElementCodecType::Decode(*this));
+                }
+            }
+        }
+        catch (...) {
+            v.Clear();
+            throw;
+        }
+    }
+
+    void ReadBytes(void* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        auto* out = static_cast<char*>(data);
+        const size_t from_buffer = std::min(size, end_ - begin_);
+        std::memcpy(out, buffer_.get() + begin_, from_buffer);
+        begin_ += from_buffer;
+        out += from_buffer;
+        size -= from_buffer;
+        while (size != 0) {
+            // Буфер пуст: остаток читается прямо в out, а всё, что придёт сверх него, - в буфер
+            iovec parts[2] = { { out, std::min(size, detail::kMaxTransfer) }, { buffer_.get(), kBufferSize } };
+            const ssize_t received = readv(fd_, parts, 2);
+            if (received < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                detail::ThrowSerializationError("readv");
+            }
+            if (received == 0) {
+                throw std::runtime_error("Vector serialization: unexpected end of stream");
+            }
+            const size_t direct = std::min(static_cast<size_t>(received), parts[0].iov_len);
+            out += direct;
+            size -= direct;
+            begin_ = 0;
+            end_ = static_cast<size_t>(received) - direct;
+        }
+    }
+
+private:
+    // Сколько байт ещё осталось в потоке, если их меньше required. Остаток известен только
+    // у обычного файла; для остальных дескрипторов возвращается максимум size_t
+    size_t AvailableBytes(size_t required) const {
+        const size_t buffered = end_ - begin_;
+        if (required <= buffered) {
+            return required;
+        }
+        struct stat info {};
+        if (fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode)) {
+            return std::numeric_limits<size_t>::max();
+        }
+        const off_t position = lseek(fd_, 0, SEEK_CUR);
+        if (position < 0 || position > info.st_size) {
+            return std::numeric_limits<size_t>::max();
+        }
+        return buffered + static_cast<size_t>(info.st_size - position);
+    }
+
+    int fd_;
+    size_t max_vector_bytes_;
+    std::unique_ptr<char[]> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+};
+
+// Арифметические типы и перечисления кодируются сырыми байтами
+template <typename T>
+struct ElementCodec<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>> {
+    static void Encode(VectorWriter& out, const T& value) {
+        out.WriteBytes(&value, sizeof(value));
+    }
+
+    static T Decode(VectorReader& in) {
+        T value;
+        in.ReadBytes(&value, sizeof(value));
+        return value;
+    }
+};
+
+// Строка кодируется длиной и символами
+template <typename Char, typename Traits, typename Allocator>
+struct ElementCodec<std::basic_string<Char, Traits, Allocator>> {
+    static_assert(std::is_trivially_copyable_v<Char>);
+
+    static void Encode(VectorWriter& out, const std::basic_string<Char, Traits, Allocator>& value) {
+        const uint64_t size = value.size();
+        out.WriteBytes(&size, sizeof(size));
+        out.WriteBytes(value.data(), value.size() * sizeof(Char));
+    }
+
+    static std::basic_string<Char, Traits, Allocator> Decode(VectorReader& in) {
+        uint64_t size = 0;
+        in.ReadBytes(&size, sizeof(size));
+        std::basic_string<Char, Traits, Allocator> value;
+        // Длина из потока не проверена: строка растёт по мере чтения, а не выделяется целиком
+        constexpr size_t kStep = size_t{ 64 } << 10;
+        for (uint64_t done = 0; done < size;) {
+            const auto step = static_cast<size_t>(std::min<uint64_t>(size - done, kStep));
+            value.resize(static_cast<size_t>(done) + step);
+            in.ReadBytes(value.data() + done, step * sizeof(Char));
+            done += step;
+        }
+        return value;
+    }
+};
+
+// Вложенный вектор кодируется длиной и элементами
+template <typename T, typename Storage, typename GrowthPolicy>
+struct ElementCodec<BasicVector<T, Storage, GrowthPolicy>> {
+    static void Encode(VectorWriter& out, const BasicVector<T, Storage, GrowthPolicy>& value) {
+        out.Write(value);
+    }
+
+    static BasicVector<T, Storage, GrowthPolicy> Decode(VectorReader& in) {
+        BasicVector<T, Storage, GrowthPolicy> value;
+        in.Read(value);
+        return value;
+    }
+};
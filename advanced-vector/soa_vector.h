@@ -0,0 +1,494 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Непрерывный участок одного столбца SoAVector. Действителен до ближайшего роста вектора
+template <typename T>
+class ColumnSpan {
+public:
+    using iterator = T*;
+
+    ColumnSpan(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    iterator begin() const noexcept {
+        return data_;
+    }
+    iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+// Массив строк из полей Fields..., в котором каждое поле хранится отдельным столбцом в своей
+// RawMemory. Проход по одному-двум полям широкой структуры читает только их столбцы, а
+// столбцы можно передавать в функции bulk_ops.h:
+//     SoAVector<int, double, std::string> rows;
+//     bulk::Sum(rows.Column<1>().Data(), rows.Size());
+//
+// Строка представлена кортежем ссылок на свои поля (Row), поэтому работает
+// структурное связывание: auto [id, price, name] = rows[i];
+// Рост выделяет все столбцы заново и переносит их так же, как Vector: при исключении
+// в EmplaceBack или Reserve вектор сохраняет прежние строки. Как и у Vector, поля без
+// копирующего конструктора, перемещение которых может выбросить исключение, могут при этом
+// остаться перемещёнными
+template <typename... Fields>
+class SoAVector {
+    static_assert(sizeof...(Fields) > 0, "SoAVector requires at least one field");
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+    static constexpr size_t kFieldCount = sizeof...(Fields);
+    static constexpr size_t kRowSize = (sizeof(Fields) + ...);
+
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    // При росте столбец копируется, если его перемещение может выбросить исключение
+    template <size_t I>
+    static constexpr bool kRelocatesByCopy = !kIsTriviallyRelocatable<Field<I>>
+        && !std::is_nothrow_move_constructible_v<Field<I>> && std::is_copy_constructible_v<Field<I>>;
+
+    // Столбец без копирующего конструктора, перемещение которого может выбросить исключение
+    template <size_t I>
+    static constexpr bool kRelocatesByThrowingMove = !kIsTriviallyRelocatable<Field<I>>
+        && !std::is_nothrow_move_constructible_v<Field<I>> && !std::is_copy_constructible_v<Field<I>>;
+
+public:
+    using Row = std::tuple<Fields&...>;
+    using ConstRow = std::tuple<const Fields&...>;
+
+private:
+    template <bool IsConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<IsConst, const SoAVector, SoAVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::conditional_t<IsConst, ConstRow, Row>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) noexcept  // NOLINT(google-explicit-constructor)
+            : owner_(other.owner_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator copy = *this;
+            --index_;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class BasicIterator<!IsConst>;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    SoAVector() = default;
+
+    // Создаёт size строк, поля которых инициализированы значением
+    explicit SoAVector(size_t size)
+        : columns_(Allocate(size))
+        , capacity_(CapacityOf(columns_)) {
+        ConstructColumns(columns_, 0, size, [](auto* first, size_t count, auto) {
+            std::uninitialized_value_construct_n(first, count);
+        });
+        size_ = size;
+    }
+
+    SoAVector(const SoAVector& other)
+        : columns_(Allocate(other.size_))
+        , capacity_(CapacityOf(columns_)) {
+        ConstructColumns(columns_, 0, other.size_, [&other](auto* first, size_t count, auto field) {
+            std::uninitialized_copy_n(std::get<decltype(field)::value>(other.columns_).GetAddress(), count, first);
+        });
+        size_ = other.size_;
+    }
+
+    SoAVector(SoAVector&& other) noexcept {
+        Swap(other);
+    }
+
+    SoAVector& operator=(const SoAVector& rhs) {
+        if (this != &rhs) {
+            SoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoAVector& operator=(SoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SoAVector() {
+        DestroyColumns(columns_, 0, size_);
+    }
+
+    void Swap(SoAVector& other) noexcept {
+        ForEachField([&](auto field) {
+            std::get<decltype(field)::value>(columns_).Swap(std::get<decltype(field)::value>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    // Добавляет строку, создавая каждое поле из соответствующего аргумента
+    template <typename... Args>
+    Row EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == kFieldCount, "EmplaceBack requires one argument per field");
+        if (size_ == capacity_) {
+            Columns new_columns = Allocate(DoublingGrowth::NextCapacity(capacity_, size_ + 1, kRowSize));
+            // Аргументы могут ссылаться на поля вектора, поэтому новая строка создаётся до переноса
+            ConstructRow(new_columns, size_, std::forward<Args>(args)...);
+            try {
+                Relocate(new_columns);
+            }
+            catch (...) {
+                DestroyColumns(new_columns, size_, 1);
+                throw;
+            }
+            Adopt(new_columns);
+        }
+        else {
+            ConstructRow(columns_, size_, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const Fields&... values) {
+        EmplaceBack(values...);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        DestroyColumns(columns_, size_, 1);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        Columns new_columns = Allocate(new_capacity);
+        Relocate(new_columns);
+        Adopt(new_columns);
+    }
+
+    // Новые строки инициализируются значением
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyColumns(columns_, new_size, size_ - new_size);
+        }
+        else if (new_size > size_) {
+            Reserve(new_size);
+            ConstructColumns(columns_, size_, new_size - size_, [](auto* first, size_t count, auto) {
+                std::uninitialized_value_construct_n(first, count);
+            });
+        }
+        size_ = new_size;
+    }
+
+    void Clear() noexcept {
+        DestroyColumns(columns_, 0, size_);
+        size_ = 0;
+    }
+
+    // Столбец поля I
+    template <size_t I>
+    ColumnSpan<Field<I>> Column() noexcept {
+        return { std::get<I>(columns_).GetAddress(), size_ };
+    }
+
+    template <size_t I>
+    ColumnSpan<const Field<I>> Column() const noexcept {
+        return { std::get<I>(columns_).GetAddress(), size_ };
+    }
+
+    Row operator[](size_t index) noexcept {
+        assert(index < size_);
+        return RowAt<Row>(columns_, index, std::index_sequence_for<Fields...>{});
+    }
+
+    ConstRow operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return RowAt<ConstRow>(columns_, index, std::index_sequence_for<Fields...>{});
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    // Вызывает fn(std::integral_constant<size_t, I>) для полей по порядку
+    template <typename Fn>
+    static void ForEachField(Fn&& fn) {
+        ForEachField(fn, std::index_sequence_for<Fields...>{});
+    }
+
+    template <typename Fn, size_t... I>
+    static void ForEachField(Fn& fn, std::index_sequence<I...>) {
+        (fn(std::integral_constant<size_t, I>{}), ...);
+    }
+
+    static Columns Allocate(size_t capacity) {
+        return Columns(RawMemory<Fields>(capacity)...);
+    }
+
+    // Аллокатор может выделить столбцам больше запрошенного, вместимость строк - наименьшая из них
+    static size_t CapacityOf(const Columns& columns) noexcept {
+        return std::apply([](const auto&... column) {
+            return std::min({ column.Capacity()... });
+        }, columns);
+    }
+
+    template <typename Result, typename Self, size_t... I>
+    static Result RowAt(Self& columns, size_t index, std::index_sequence<I...>) noexcept {
+        return Result(std::get<I>(columns)[index]...);
+    }
+
+    // Создаёт строку index полями из args. Если создание поля выбросило исключение,
+    // уже созданные поля строки разрушаются
+    template <typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, Args&&... args) {
+        std::tuple<Args&&...> forwarded(std::forward<Args>(args)...);
+        ConstructColumns(columns, index, 1, [&forwarded](auto* slot, size_t, auto field) {
+            using Value = std::remove_pointer_t<decltype(slot)>;
+            new (slot) Value(std::get<decltype(field)::value>(std::move(forwarded)));
+        });
+    }
+
+    // Вызывает construct(first, count, field) для [first, first + count) каждого столбца.
+    // construct создаёт все элементы или не создаёт ни одного; если он выбросил исключение,
+    // участки предыдущих столбцов разрушаются
+    template <typename Construct>
+    static void ConstructColumns(Columns& columns, size_t first, size_t count, Construct&& construct) {
+        size_t constructed = 0;
+        try {
+            ForEachField([&](auto field) {
+                construct(std::get<decltype(field)::value>(columns) + first, count, field);
+                ++constructed;
+            });
+        }
+        catch (...) {
+            ForEachField([&](auto field) {
+                if (decltype(field)::value < constructed) {
+                    std::destroy_n(std::get<decltype(field)::value>(columns) + first, count);
+                }
+            });
+            throw;
+        }
+    }
+
+    static void DestroyColumns(Columns& columns, size_t first, size_t count) noexcept {
+        ForEachField([&](auto field) {
+            std::destroy_n(std::get<decltype(field)::value>(columns) + first, count);
+        });
+    }
+
+    // Переносит строки в new_columns. Сначала создаются все элементы, которые могут выбросить
+    // исключение: копируются столбцы, перемещение которых может его выбросить, а столбцы без
+    // копирующего конструктора перемещаются как есть. Если это не удалось, созданные элементы
+    // разрушаются, а исходные столбцы остаются на месте: скопированные - нетронутыми, а
+    // некопируемые - возможно, перемещёнными, как у Vector. Остальные столбцы перемещаются
+    // без исключений, и только после этого исходные элементы разрушаются
+    void Relocate(Columns& new_columns) {
+        std::array<bool, kFieldCount> created{};
+        try {
+            ForEachField([&](auto field) {
+                constexpr size_t kField = decltype(field)::value;
+                Field<kField>* from = std::get<kField>(columns_).GetAddress();
+                Field<kField>* to = std::get<kField>(new_columns).GetAddress();
+                if constexpr (kRelocatesByCopy<kField>) {
+                    std::uninitialized_copy_n(from, size_, to);
+                    created[kField] = true;
+                }
+                else if constexpr (kRelocatesByThrowingMove<kField>) {
+                    std::uninitialized_move_n(from, size_, to);
+                    created[kField] = true;
+                }
+            });
+        }
+        catch (...) {
+            ForEachField([&](auto field) {
+                if (created[decltype(field)::value]) {
+                    std::destroy_n(std::get<decltype(field)::value>(new_columns).GetAddress(), size_);
+                }
+            });
+            throw;
+        }
+        ForEachField([&](auto field) {
+            constexpr size_t kField = decltype(field)::value;
+            using Value = Field<kField>;
+            Value* from = std::get<kField>(columns_).GetAddress();
+            Value* to = std::get<kField>(new_columns).GetAddress();
+            if constexpr (kIsTriviallyRelocatable<Value>) {
+                if (size_ != 0) {
+                    std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), size_ * sizeof(Value));
+                }
+            }
+            else {
+                if constexpr (!kRelocatesByCopy<kField> && !kRelocatesByThrowingMove<kField>) {
+                    std::uninitialized_move_n(from, size_, to);
+                }
+                std::destroy_n(from, size_);
+            }
+        });
+    }
+
+    // Заменяет столбцы на new_columns, элементы в которые уже перенесены
+    void Adopt(Columns& new_columns) noexcept {
+        ForEachField([&](auto field) {
+            std::get<decltype(field)::value>(columns_).Swap(std::get<decltype(field)::value>(new_columns));
+        });
+        capacity_ = CapacityOf(columns_);
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
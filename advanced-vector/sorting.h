@@ -0,0 +1,478 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+// Параллельные сортировка, удаление повторов и слияние векторов. Работа делится на части
+// исполнителем ParallelPolicy, как у Resize и Clear: короткие векторы обрабатываются
+// вызывающим потоком.
+//
+// Сортировка сравнением сортирует части вектора независимо, а затем сливает соседние
+// отсортированные участки попарно, пока не останется один. Каждый раунд слияния делится
+// на части поровну по выходу: границы частей находятся двоичным поиском (merge path),
+// поэтому даже последнее слияние двух половин загружает все потоки.
+// Целые числа и числа с плавающей точкой, сортируемые по возрастанию, сортируются
+// поразрядно по байтам (LSD radix sort) без сравнений.
+//
+// Промежуточный буфер на размер вектора сортировки берут из SortBuffer. Буфер, переданный
+// явно, хранит память между вызовами, и повторные сортировки обходятся без выделений
+template <typename T, typename Allocator = std::allocator<T>>
+class SortBuffer {
+public:
+    SortBuffer() = default;
+
+    explicit SortBuffer(const Allocator& alloc) noexcept
+        : memory_(alloc) {
+    }
+
+    // Возвращает неинициализированную память не меньше чем под count элементов.
+    // Прежняя память освобождается, если её не хватает
+    T* Acquire(size_t count) {
+        if (count > memory_.Capacity()) {
+            RawMemory<T, Allocator> memory(count, memory_.GetAllocator());
+            memory_.Swap(memory);
+        }
+        return memory_.GetAddress();
+    }
+
+    size_t Capacity() const noexcept {
+        return memory_.Capacity();
+    }
+
+    void Release() noexcept {
+        RawMemory<T, Allocator> empty(memory_.GetAllocator());
+        memory_.Swap(empty);
+    }
+
+private:
+    RawMemory<T, Allocator> memory_;
+};
+
+namespace detail {
+
+// Вызывает task(chunk) для каждой части плана. Исключение первой неудавшейся части
+// пробрасывается, когда завершатся остальные. Если частей меньше двух, весь диапазон -
+// это часть 0, и она выполняется вызывающим потоком
+template <typename Task>
+void RunChunks(const ChunkPlan& plan, Task&& task) {
+    if (plan.count < 2) {
+        task(size_t{ 0 });
+        return;
+    }
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    plan.executor->Run(plan.count, [&](size_t chunk) {
+        try {
+            task(chunk);
+        }
+        catch (...) {
+            std::lock_guard lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Поразрядная сортировка меньше чем kRadixSortThreshold элементов проигрывает std::sort
+inline constexpr size_t kRadixSortThreshold = 1024;
+
+template <typename T, typename Compare>
+inline constexpr bool kRadixSortable = (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>>)
+    && ((std::is_integral_v<T> && !std::is_same_v<T, bool>)
+        || (std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559 && sizeof(T) <= sizeof(uint64_t)));
+
+template <typename T>
+using RadixKey = std::conditional_t<sizeof(T) == 1, uint8_t,
+                 std::conditional_t<sizeof(T) == 2, uint16_t,
+                 std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+// Беззнаковый ключ, порядок которого совпадает с порядком значений: у знаковых целых
+// инвертируется знаковый бит, у отрицательных чисел с плавающей точкой - все биты.
+// Поэтому -0.0 оказывается перед +0.0, а NaN - по краям
+template <typename T>
+RadixKey<T> ToRadixKey(T value) noexcept {
+    using Key = RadixKey<T>;
+    constexpr Key kSignBit = static_cast<Key>(Key{ 1 } << (sizeof(Key) * 8 - 1));
+    if constexpr (std::is_floating_point_v<T>) {
+        Key bits = 0;
+        std::memcpy(&bits, &value, sizeof(value));
+        return (bits & kSignBit) != 0 ? static_cast<Key>(~bits) : static_cast<Key>(bits | kSignBit);
+    }
+    else if constexpr (std::is_signed_v<T>) {
+        return static_cast<Key>(static_cast<Key>(value) ^ kSignBit);
+    }
+    else {
+        return static_cast<Key>(value);
+    }
+}
+
+// Устойчивая поразрядная сортировка по байтам, от младшего к старшему. За проход каждая
+// часть считает свои байты, затем части раскладывают элементы по заранее вычисленным
+// позициям. Байт, одинаковый у всех элементов, пропускается
+template <typename T, typename Buffer>
+void RadixSort(T* data, size_t size, Buffer& buffer, const ParallelPolicy& policy) {
+    constexpr size_t kBuckets = 256;
+    const ChunkPlan plan = PlanChunks(policy, size);
+    const size_t chunks = std::max<size_t>(plan.count, 1);
+    const auto counts = std::make_unique<size_t[]>(chunks * kBuckets);
+    const auto digit = [](T value, size_t shift) noexcept {
+        return static_cast<size_t>((ToRadixKey(value) >> shift) & (kBuckets - 1));
+    };
+
+    T* source = data;
+    T* target = buffer.Acquire(size);
+    for (size_t shift = 0; shift < sizeof(T) * 8; shift += 8) {
+        RunChunks(plan, [&](size_t chunk) {
+            size_t* count = counts.get() + chunk * kBuckets;
+            std::fill_n(count, kBuckets, 0);
+            const T* first = source + plan.Offset(chunk);
+            for (size_t i = 0, n = plan.Size(chunk, size); i < n; ++i) {
+                ++count[digit(first[i], shift)];
+            }
+        });
+        const size_t first_digit = digit(source[0], shift);
+        size_t same = 0;
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            same += counts[chunk * kBuckets + first_digit];
+        }
+        if (same == size) {
+            continue;
+        }
+        // Элементы с меньшим байтом идут раньше, а с одинаковым - в порядке частей
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                offset += std::exchange(counts[chunk * kBuckets + bucket], offset);
+            }
+        }
+        RunChunks(plan, [&](size_t chunk) {
+            size_t* position = counts.get() + chunk * kBuckets;
+            const T* first = source + plan.Offset(chunk);
+            for (size_t i = 0, n = plan.Size(chunk, size); i < n; ++i) {
+                target[position[digit(first[i], shift)]++] = first[i];
+            }
+        });
+        std::swap(source, target);
+    }
+    if (source != data) {
+        RunChunks(plan, [&](size_t chunk) {
+            std::copy_n(source + plan.Offset(chunk), plan.Size(chunk, size), data + plan.Offset(chunk));
+        });
+    }
+}
+
+// Сколько элементов a попадает в первые k элементов устойчивого слияния a и b
+template <typename T, typename Compare>
+size_t MergeRank(size_t k, T* a, size_t a_size, T* b, size_t b_size, Compare& comp) {
+    size_t low = k > b_size ? k - b_size : 0;
+    size_t high = std::min(k, a_size);
+    while (low < high) {
+        const size_t i = low + (high - low) / 2;
+        if (comp(b[k - i - 1], a[i])) {
+            high = i;
+        }
+        else {
+            low = i + 1;
+        }
+    }
+    return low;
+}
+
+// Записывает в out[low, high) элементы с этими номерами из устойчивого слияния a и b,
+// перемещая их. a_low и a_high - значения MergeRank для low и high. Части слияния
+// перемещают элементы, которые читает MergeRank соседних частей, поэтому ранги всех
+// частей вычисляются заранее. Слияние написано вручную, а не через std::merge с move_iterator,
+// чтобы comp получал lvalue, как в std::sort: сравнение по значению иначе опустошало бы элементы
+template <typename T, typename Compare>
+void MergePart(T* a, T* b, size_t low, size_t high, size_t a_low, size_t a_high, T* out, Compare& comp) {
+    T* a_first = a + a_low;
+    T* const a_last = a + a_high;
+    T* b_first = b + (low - a_low);
+    T* const b_last = b + (high - a_high);
+    T* result = out + low;
+    for (; a_first != a_last && b_first != b_last; ++result) {
+        // При равенстве первым идёт элемент a, поэтому слияние устойчиво
+        if (comp(*b_first, *a_first)) {
+            *result = std::move(*b_first++);
+        }
+        else {
+            *result = std::move(*a_first++);
+        }
+    }
+    std::move(b_first, b_last, std::move(a_first, a_last, result));
+}
+
+// Сортирует части независимо и сливает их попарно через буфер. Слияние устойчиво, поэтому
+// сортировка устойчива, если устойчиво сортируются части
+template <bool Stable, typename T, typename Compare, typename Buffer>
+void MergeSort(T* data, size_t size, Compare& comp, Buffer& buffer, const ParallelPolicy& policy) {
+    const ChunkPlan plan = PlanChunks(policy, size);
+    if (plan.count < 2) {
+        if constexpr (Stable) {
+            std::stable_sort(data, data + size, comp);
+        }
+        else {
+            std::sort(data, data + size, comp);
+        }
+        return;
+    }
+    RunChunks(plan, [&](size_t chunk) {
+        T* first = data + plan.Offset(chunk);
+        if constexpr (Stable) {
+            std::stable_sort(first, first + plan.Size(chunk, size), comp);
+        }
+        else {
+            std::sort(first, first + plan.Size(chunk, size), comp);
+        }
+    });
+
+    T* source = data;
+    T* target = buffer.Acquire(size);
+    T* const scratch = target;
+    if constexpr (!std::is_trivially_copyable_v<T>) {
+        // Слияния присваивают элементы, поэтому буфер сначала заполняется перемещёнными элементами
+        ParallelConstruct(policy, scratch, size, [data](T* first, size_t offset, size_t count) {
+            std::uninitialized_move_n(data + offset, count, first);
+        });
+        std::swap(source, target);
+    }
+    // ranks[chunk] - ранг начала части внутри пары участков, которой оно принадлежит
+    const auto ranks = std::make_unique<size_t[]>(plan.count + 1);
+    try {
+        for (size_t width = plan.size; width < size; width *= 2) {
+            const auto pair_of = [width](size_t position) noexcept {
+                return position / (2 * width) * (2 * width);
+            };
+            RunChunks(plan, [&](size_t chunk) {
+                const size_t low = plan.Offset(chunk);
+                const size_t pair = pair_of(low);
+                const size_t a_size = std::min(width, size - pair);
+                const size_t b_size = std::min(width, size - pair - a_size);
+                ranks[chunk] = MergeRank(low - pair, source + pair, a_size, source + pair + a_size, b_size, comp);
+            });
+            RunChunks(plan, [&](size_t chunk) {
+                const size_t low = plan.Offset(chunk);
+                const size_t high = low + plan.Size(chunk, size);
+                for (size_t pair = pair_of(low); pair < high; pair += 2 * width) {
+                    const size_t a_size = std::min(width, size - pair);
+                    const size_t pair_size = a_size + std::min(width, size - pair - a_size);
+                    const size_t part_low = std::max(low, pair) - pair;
+                    const size_t part_high = std::min(high, pair + pair_size) - pair;
+                    const size_t a_low = pair <= low ? ranks[chunk] : 0;
+                    const size_t a_high = high < pair + pair_size ? ranks[chunk + 1] : a_size;
+                    MergePart(source + pair, source + pair + a_size, part_low, part_high, a_low, a_high, target + pair, comp);
+                }
+            });
+            std::swap(source, target);
+        }
+        if (source != data) {
+            RunChunks(plan, [&](size_t chunk) {
+                T* first = source + plan.Offset(chunk);
+                std::move(first, first + plan.Size(chunk, size), data + plan.Offset(chunk));
+            });
+        }
+    }
+    catch (...) {
+        if (source != data) {
+            std::move(source, source + size, data);
+        }
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            ParallelDestroy(policy, scratch, size);
+        }
+        throw;
+    }
+    if constexpr (!std::is_trivially_copyable_v<T>) {
+        ParallelDestroy(policy, scratch, size);
+    }
+}
+
+}  // namespace detail
+
+// Сортирует v по comp. Если comp выбросит исключение, элементы v останутся допустимыми,
+// но их значения и порядок не определены
+template <typename T, typename Storage, typename GrowthPolicy, typename Compare, typename Allocator>
+void ParallelSort(BasicVector<T, Storage, GrowthPolicy>& v, Compare comp, SortBuffer<T, Allocator>& buffer,
+                  const ParallelPolicy& policy = ParallelPolicy()) {
+    if (v.Size() < 2) {
+        return;
+    }
+    if constexpr (detail::kRadixSortable<T, Compare>) {
+        if (v.Size() >= detail::kRadixSortThreshold) {
+            detail::RadixSort(v.Data(), v.Size(), buffer, policy);
+            return;
+        }
+    }
+    detail::MergeSort<false>(v.Data(), v.Size(), comp, buffer, policy);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy, typename Compare>
+void ParallelSort(BasicVector<T, Storage, GrowthPolicy>& v, Compare comp, const ParallelPolicy& policy = ParallelPolicy()) {
+    SortBuffer<T, typename BasicVector<T, Storage, GrowthPolicy>::allocator_type> buffer(v.GetAllocator());
+    ParallelSort(v, comp, buffer, policy);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy>
+void ParallelSort(BasicVector<T, Storage, GrowthPolicy>& v, const ParallelPolicy& policy = ParallelPolicy()) {
+    ParallelSort(v, std::less<>(), policy);
+}
+
+// Как ParallelSort, но равные элементы сохраняют взаимный порядок. Поразрядно сортируются
+// только целые числа: -0.0 и +0.0 равны, но их ключи различаются
+template <typename T, typename Storage, typename GrowthPolicy, typename Compare, typename Allocator>
+void ParallelStableSort(BasicVector<T, Storage, GrowthPolicy>& v, Compare comp, SortBuffer<T, Allocator>& buffer,
+                        const ParallelPolicy& policy = ParallelPolicy()) {
+    if (v.Size() < 2) {
+        return;
+    }
+    if constexpr (detail::kRadixSortable<T, Compare> && std::is_integral_v<T>) {
+        if (v.Size() >= detail::kRadixSortThreshold) {
+            detail::RadixSort(v.Data(), v.Size(), buffer, policy);
+            return;
+        }
+    }
+    detail::MergeSort<true>(v.Data(), v.Size(), comp, buffer, policy);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy, typename Compare>
+void ParallelStableSort(BasicVector<T, Storage, GrowthPolicy>& v, Compare comp, const ParallelPolicy& policy = ParallelPolicy()) {
+    SortBuffer<T, typename BasicVector<T, Storage, GrowthPolicy>::allocator_type> buffer(v.GetAllocator());
+    ParallelStableSort(v, comp, buffer, policy);
+}
+
+template <typename T, typename Storage, typename GrowthPolicy>
+void ParallelStableSort(BasicVector<T, Storage, GrowthPolicy>& v, const ParallelPolicy& policy = ParallelPolicy()) {
+    ParallelStableSort(v, std::less<>(), policy);
+}
+
+// Оставляет из каждой группы подряд идущих элементов, для которых pred(первый, x) истинно,
+// только первый, как std::unique, и удаляет остальные. Возвращает количество удалённых
+// элементов. Части просматриваются параллельно, а затем сдвигаются к началу в одном потоке
+template <typename T, typename Storage, typename GrowthPolicy, typename BinaryPredicate>
+size_t Unique(BasicVector<T, Storage, GrowthPolicy>& v, BinaryPredicate pred, const ParallelPolicy& policy = ParallelPolicy()) {
+    T* const data = v.Data();
+    const size_t size = v.Size();
+    const detail::ChunkPlan plan = detail::PlanChunks(policy, size);
+    size_t kept = 0;
+    if (plan.count < 2) {
+        kept = static_cast<size_t>(std::unique(data, data + size, pred) - data);
+    }
+    else {
+        const auto firsts = std::make_unique<size_t[]>(plan.count);
+        const auto lasts = std::make_unique<size_t[]>(plan.count);
+        // Начало части, повторяющее последний элемент предыдущей, пропускается. Элементы
+        // ещё не сдвинуты, поэтому соседние части читаются без гонок
+        detail::RunChunks(plan, [&](size_t chunk) {
+            size_t first = plan.Offset(chunk);
+            const size_t last = first + plan.Size(chunk, size);
+            while (chunk != 0 && first < last && pred(data[plan.Offset(chunk) - 1], data[first])) {
+                ++first;
+            }
+            firsts[chunk] = first;
+            lasts[chunk] = last;
+        });
+        detail::RunChunks(plan, [&](size_t chunk) {
+            lasts[chunk] = static_cast<size_t>(std::unique(data + firsts[chunk], data + lasts[chunk], pred) - data);
+        });
+        for (size_t chunk = 0; chunk < plan.count; ++chunk) {
+            if (kept != firsts[chunk]) {
+                std::move(data + firsts[chunk], data + lasts[chunk], data + kept);
+            }
+            kept += lasts[chunk] - firsts[chunk];
+        }
+    }
+    v.Erase(v.begin() + kept, v.end());
+    return size - kept;
+}
+
+template <typename T, typename Storage, typename GrowthPolicy>
+size_t Unique(BasicVector<T, Storage, GrowthPolicy>& v, const ParallelPolicy& policy = ParallelPolicy()) {
+    return Unique(v, std::equal_to<>(), policy);
+}
+
+// Сливает отсортированные по comp векторы: dst получает элементы обоих в порядке comp
+// (при равенстве элементы dst идут раньше), а src остаётся пустым. Если src целиком
+// следует за dst или предшествует ему, элементы src вставляются одним перемещением.
+// Иначе слияние пишется в новый буфер частями на исполнителе policy. Если comp выбросит
+// исключение, элементы dst и src останутся допустимыми, но могут оказаться перемещёнными
+template <typename T, typename Storage, typename GrowthPolicy, typename Compare>
+void MergeSorted(BasicVector<T, Storage, GrowthPolicy>& dst, BasicVector<T, Storage, GrowthPolicy>&& src, Compare comp,
+                 const ParallelPolicy& policy = ParallelPolicy()) {
+    const size_t dst_size = dst.Size();
+    const size_t src_size = src.Size();
+    if (src_size == 0) {
+        return;
+    }
+    T* const a = dst.Data();
+    T* const b = src.Data();
+    if (dst_size == 0 && dst.GetAllocator() == src.GetAllocator()) {
+        dst.Swap(src);
+    }
+    else if (dst_size == 0 || !comp(b[0], a[dst_size - 1])) {
+        dst.Insert(dst.end(), std::make_move_iterator(b), std::make_move_iterator(b + src_size));
+    }
+    else if (comp(b[src_size - 1], a[0])) {
+        dst.Insert(dst.begin(), std::make_move_iterator(b), std::make_move_iterator(b + src_size));
+    }
+    else {
+        const size_t size = dst_size + src_size;
+        BasicVector<T, Storage, GrowthPolicy> result(dst.GetAllocator());
+        if constexpr (std::is_default_constructible_v<T>) {
+            // Создание элементов, которые сразу перезапишет слияние, тоже делится на части
+            if constexpr (std::is_trivially_default_constructible_v<T>) {
+                result.ResizeDefaultInit(size);
+            }
+            else {
+                result.Resize(size, policy);
+            }
+            const detail::ChunkPlan plan = detail::PlanChunks(policy, size);
+            const size_t chunks = std::max<size_t>(plan.count, 1);
+            const auto ranks = std::make_unique<size_t[]>(chunks + 1);
+            ranks[chunks] = dst_size;
+            detail::RunChunks(plan, [&](size_t chunk) {
+                ranks[chunk] = detail::MergeRank(plan.Offset(chunk), a, dst_size, b, src_size, comp);
+            });
+            detail::RunChunks(plan, [&](size_t chunk) {
+                const size_t low = plan.Offset(chunk);
+                detail::MergePart(a, b, low, low + plan.Size(chunk, size), ranks[chunk], ranks[chunk + 1], result.Data(), comp);
+            });
+        }
+        else {
+            result.Reserve(size);
+            size_t i = 0;
+            size_t j = 0;
+            while (i < dst_size && j < src_size) {
+                result.EmplaceBack(comp(b[j], a[i]) ? std::move(b[j++]) : std::move(a[i++]));
+            }
+            for (; i < dst_size; ++i) {
+                result.EmplaceBack(std::move(a[i]));
+            }
+            for (; j < src_size; ++j) {
+                result.EmplaceBack(std::move(b[j]));
+            }
+        }
+        // Буфер результата выделен аллокатором dst, поэтому векторы можно обменять
+        dst.Swap(result);
+    }
+    src.Clear();
+}
+
+template <typename T, typename Storage, typename GrowthPolicy>
+void MergeSorted(BasicVector<T, Storage, GrowthPolicy>& dst, BasicVector<T, Storage, GrowthPolicy>&& src,
+                 const ParallelPolicy& policy = ParallelPolicy()) {
+    MergeSorted(dst, std::move(src), std::less<>(), policy);
+}
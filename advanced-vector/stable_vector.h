@@ -0,0 +1,335 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace detail {
+
+// Наибольшая степень двойки, при которой блок занимает не больше 16 КБ (но не меньше одного элемента)
+template <typename T>
+constexpr size_t DefaultChunkSize() noexcept {
+    size_t size = 1;
+    while (size * 2 * sizeof(T) <= 16384) {
+        size *= 2;
+    }
+    return size;
+}
+
+}  // namespace detail
+
+// Массив из блоков фиксированного размера ChunkSize, каждый из которых - отдельная RawMemory.
+// Рост добавляет новый блок и не переносит уже созданные элементы, поэтому ссылки и указатели
+// на элементы остаются действительными до их удаления. Итераторы хранят индекс элемента
+// и также переживают рост. Доступ по индексу - два обращения: к каталогу блоков и к элементу
+template <typename T, size_t ChunkSize = detail::DefaultChunkSize<T>(), typename Allocator = std::allocator<T>>
+class StableVector {
+    static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Chunk = RawMemory<T, Allocator>;
+    using Directory = Vector<Chunk, typename AllocTraits::template rebind_alloc<Chunk>>;
+
+    template <bool IsConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<IsConst, const StableVector, StableVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) noexcept  // NOLINT(google-explicit-constructor)
+            : owner_(other.owner_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &(*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator copy = *this;
+            --index_;
+            return copy;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class BasicIterator<!IsConst>;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using allocator_type = Allocator;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    static constexpr size_t kChunkSize = ChunkSize;
+
+    StableVector() = default;
+
+    explicit StableVector(const Allocator& alloc)
+        : alloc_(alloc)
+        , chunks_(typename Directory::allocator_type(alloc)) {
+    }
+
+    StableVector(const StableVector& other)
+        : StableVector(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc_)) {
+        Reserve(other.size_);
+        other.ForEachChunk([this](const T* first, size_t count) {
+            std::uninitialized_copy_n(first, count, chunks_[size_ / ChunkSize] + size_ % ChunkSize);
+            size_ += count;
+        });
+    }
+
+    StableVector(StableVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , chunks_(std::move(other.chunks_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    StableVector& operator=(const StableVector& rhs) {
+        if (this != &rhs) {
+            StableVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    StableVector& operator=(StableVector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                         || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if (AllocTraits::propagate_on_container_move_assignment::value || alloc_ == rhs.alloc_) {
+                Swap(rhs);
+            }
+            else {
+                // Блоки rhs принадлежат чужому аллокатору, поэтому элементы перемещаются по одному
+                Clear();
+                Reserve(rhs.size_);
+                rhs.ForEachChunk([this](T* first, size_t count) {
+                    detail::UninitializedMoveN(first, count, chunks_[size_ / ChunkSize].GetAddress());
+                    size_ += count;
+                });
+            }
+        }
+        return *this;
+    }
+
+    ~StableVector() {
+        Clear();
+    }
+
+    void Swap(StableVector& other) noexcept {
+        using std::swap;
+        swap(alloc_, other.alloc_);
+        chunks_.Swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t chunk = size_ / ChunkSize;
+        if (chunk == chunks_.Size()) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+        T* slot = new (chunks_[chunk] + size_ % ChunkSize) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Освободившиеся блоки остаются в резерве, их возвращает ShrinkToFit.
+    // Как и Vector::PopBack, ничего не делает с пустым массивом
+    void PopBack() noexcept {
+        if (size_ > 0) {
+            --size_;
+            std::destroy_at(chunks_[size_ / ChunkSize] + size_ % ChunkSize);
+        }
+    }
+
+    void Clear() noexcept {
+        ForEachChunk([](T* first, size_t count) {
+            std::destroy_n(first, count);
+        });
+        size_ = 0;
+    }
+
+    // Выделяет блоки так, чтобы вместить capacity элементов
+    void Reserve(size_t capacity) {
+        const size_t chunk_count = (capacity + ChunkSize - 1) / ChunkSize;
+        chunks_.Reserve(chunk_count);
+        while (chunks_.Size() < chunk_count) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+    }
+
+    // Освобождает блоки, в которых нет элементов
+    void ShrinkToFit() {
+        const size_t used_chunks = (size_ + ChunkSize - 1) / ChunkSize;
+        chunks_.Erase(chunks_.begin() + used_chunks, chunks_.end());
+        chunks_.ShrinkToFit();
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<StableVector&>(*this)[index];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return chunks_.Size() * ChunkSize;
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Передаёт fn(first, count) непрерывные участки элементов блок за блоком.
+    // Обход внутри участка не требует обращений к каталогу блоков
+    template <typename Fn>
+    void ForEachChunk(Fn&& fn) {
+        size_t remaining = size_;
+        for (size_t chunk = 0; remaining != 0; ++chunk) {
+            const size_t count = std::min(remaining, ChunkSize);
+            fn(chunks_[chunk].GetAddress(), count);
+            remaining -= count;
+        }
+    }
+
+    template <typename Fn>
+    void ForEachChunk(Fn&& fn) const {
+        size_t remaining = size_;
+        for (size_t chunk = 0; remaining != 0; ++chunk) {
+            const size_t count = std::min(remaining, ChunkSize);
+            fn(static_cast<const T*>(chunks_[chunk].GetAddress()), count);
+            remaining -= count;
+        }
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    [[no_unique_address]] Allocator alloc_;
+    Directory chunks_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,171 @@
+#include "bulk_ops.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Ядра одного набора инструкций для типа T
+template <typename T>
+struct Kernels {
+    std::string name;
+    void (*fill)(T*, size_t, T);
+    size_t (*find)(const T*, size_t, T);
+    size_t (*count)(const T*, size_t, T);
+    bulk::MinMaxResult<T> (*min_max)(const T*, size_t);
+    bulk::SumType<T> (*sum)(const T*, size_t);
+    void (*transform[5])(const T*, size_t, T*, T);
+};
+
+constexpr bulk::TransformOp kOps[] = {
+    bulk::TransformOp::kAdd, bulk::TransformOp::kSubtract, bulk::TransformOp::kMultiply,
+    bulk::TransformOp::kMin, bulk::TransformOp::kMax,
+};
+
+#define BULK_KERNELS(Suffix)                                                                                \
+    Kernels<T> {                                                                                            \
+        #Suffix, &bulk::detail::Fill##Suffix<T>, &bulk::detail::Find##Suffix<T>,                            \
+            &bulk::detail::Count##Suffix<T>, &bulk::detail::MinMax##Suffix<T>, &bulk::detail::Sum##Suffix<T>, { \
+            &bulk::detail::Transform##Suffix<bulk::TransformOp::kAdd, T>,                                   \
+            &bulk::detail::Transform##Suffix<bulk::TransformOp::kSubtract, T>,                              \
+            &bulk::detail::Transform##Suffix<bulk::TransformOp::kMultiply, T>,                              \
+            &bulk::detail::Transform##Suffix<bulk::TransformOp::kMin, T>,                                   \
+            &bulk::detail::Transform##Suffix<bulk::TransformOp::kMax, T>,                                   \
+        }                                                                                                   \
+    }
+
+// Ядра, которые можно выполнить на этом процессоре, и общедоступные функции с выбором ядра
+template <typename T>
+std::vector<Kernels<T>> AvailableKernels() {
+    std::vector<Kernels<T>> kernels;
+    kernels.push_back(Kernels<T>{ "dispatch", &bulk::Fill<T>, &bulk::Find<T>, &bulk::Count<T>, &bulk::MinMax<T>,
+                                  &bulk::Sum<T>, {
+                                      &bulk::Transform<bulk::TransformOp::kAdd, T>,
+                                      &bulk::Transform<bulk::TransformOp::kSubtract, T>,
+                                      &bulk::Transform<bulk::TransformOp::kMultiply, T>,
+                                      &bulk::Transform<bulk::TransformOp::kMin, T>,
+                                      &bulk::Transform<bulk::TransformOp::kMax, T>,
+                                  } });
+#if defined(ADVANCED_VECTOR_BULK_SIMD)
+    if (bulk::GetSimdLevel() != bulk::SimdLevel::kScalar) {
+        kernels.push_back(BULK_KERNELS(Base));
+    }
+#if defined(__x86_64__)
+    if (bulk::GetSimdLevel() == bulk::SimdLevel::kAvx2 || bulk::GetSimdLevel() == bulk::SimdLevel::kAvx512) {
+        kernels.push_back(BULK_KERNELS(Avx2));
+    }
+    if (bulk::GetSimdLevel() == bulk::SimdLevel::kAvx512) {
+        kernels.push_back(BULK_KERNELS(Avx512));
+    }
+#endif
+#endif
+    return kernels;
+}
+
+#undef BULK_KERNELS
+
+// Небольшие целые значения: суммы чисел с плавающей точкой вычисляются точно
+template <typename T>
+std::vector<T> RandomValues(size_t count, std::mt19937& random) {
+    std::uniform_int_distribution<int> distribution(std::is_signed_v<T> ? -100 : 0, 100);
+    std::vector<T> values(count);
+    for (T& value : values) {
+        value = static_cast<T>(distribution(random));
+    }
+    return values;
+}
+
+template <typename T>
+class BulkOpsTest : public testing::Test {};
+
+using ElementTypes = testing::Types<int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t, int64_t, uint64_t, float, double>;
+TYPED_TEST_SUITE(BulkOpsTest, ElementTypes);
+
+// Длины покрывают пустой массив, хвосты короче регистра и несколько регистров AVX-512,
+// а смещение - невыровненное начало
+constexpr size_t kLengths[] = { 0, 1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 255, 1000 };
+constexpr size_t kOffsets[] = { 0, 1, 3 };
+
+}  // namespace
+
+TYPED_TEST(BulkOpsTest, KernelsMatchScalarLoops) {
+    using T = TypeParam;
+    std::mt19937 random(42);
+    for (const Kernels<T>& kernels : AvailableKernels<T>()) {
+        SCOPED_TRACE(kernels.name);
+        for (size_t length : kLengths) {
+            for (size_t offset : kOffsets) {
+                SCOPED_TRACE("length " + std::to_string(length) + ", offset " + std::to_string(offset));
+                std::vector<T> storage = RandomValues<T>(length + offset, random);
+                const T* data = storage.data() + offset;
+
+                bulk::SumType<T> sum{};
+                for (size_t i = 0; i < length; ++i) {
+                    sum += static_cast<bulk::SumType<T>>(data[i]);
+                }
+                EXPECT_EQ(kernels.sum(data, length), sum);
+
+                if (length != 0) {
+                    const auto [min, max] = std::minmax_element(data, data + length);
+                    const bulk::MinMaxResult<T> result = kernels.min_max(data, length);
+                    EXPECT_EQ(result.min, *min);
+                    EXPECT_EQ(result.max, *max);
+                }
+
+                const T needle = length != 0 ? data[length / 2] : T{ 1 };
+                EXPECT_EQ(kernels.find(data, length, needle), static_cast<size_t>(std::find(data, data + length, needle) - data));
+                EXPECT_EQ(kernels.find(data, length, T{ 127 }), length);
+                EXPECT_EQ(kernels.count(data, length, needle), static_cast<size_t>(std::count(data, data + length, needle)));
+
+                const T operand = static_cast<T>(3);
+                for (size_t op = 0; op < std::size(kOps); ++op) {
+                    std::vector<T> expected(length);
+                    std::vector<T> actual(length);
+                    for (size_t i = 0; i < length; ++i) {
+                        switch (kOps[op]) {
+                        case bulk::TransformOp::kAdd:
+                            expected[i] = bulk::detail::ApplyScalar<bulk::TransformOp::kAdd>(data[i], operand);
+                            break;
+                        case bulk::TransformOp::kSubtract:
+                            expected[i] = bulk::detail::ApplyScalar<bulk::TransformOp::kSubtract>(data[i], operand);
+                            break;
+                        case bulk::TransformOp::kMultiply:
+                            expected[i] = bulk::detail::ApplyScalar<bulk::TransformOp::kMultiply>(data[i], operand);
+                            break;
+                        case bulk::TransformOp::kMin:
+                            expected[i] = std::min(data[i], operand);
+                            break;
+                        case bulk::TransformOp::kMax:
+                            expected[i] = std::max(data[i], operand);
+                            break;
+                        }
+                    }
+                    kernels.transform[op](data, length, actual.data(), operand);
+                    EXPECT_EQ(actual, expected) << "op " << op;
+                }
+
+                kernels.fill(storage.data() + offset, length, T{ 5 });
+                EXPECT_EQ(std::count(data, data + length, T{ 5 }), static_cast<std::ptrdiff_t>(length));
+            }
+        }
+    }
+}
+
+TEST(BulkOpsVectorTest, OverloadsForVector) {
+    Vector<int32_t> v(1000);
+    bulk::Fill(v, 2);
+    v[700] = 9;
+    EXPECT_EQ(bulk::Find(v, 9), 700u);
+    EXPECT_EQ(bulk::Count(v, 2), 999u);
+    EXPECT_EQ(bulk::Sum(v), 999 * 2 + 9);
+    bulk::Transform<bulk::TransformOp::kMultiply>(v, 3);
+    const bulk::MinMaxResult<int32_t> result = bulk::MinMax(v);
+    EXPECT_EQ(result.min, 6);
+    EXPECT_EQ(result.max, 27);
+}
@@ -0,0 +1,78 @@
+#include "compressed_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+template <typename Int>
+void ExpectSameElements(const CompressedVector<Int>& compressed, const std::vector<Int>& expected) {
+    ASSERT_EQ(compressed.Size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(compressed[i], expected[i]) << "index " << i;
+    }
+    std::vector<Int> decoded;
+    compressed.ForEachBlock([&decoded](const Int* first, size_t count) {
+        decoded.insert(decoded.end(), first, first + count);
+    });
+    EXPECT_EQ(decoded, expected);
+    const Vector<Int> unpacked = compressed.ToVector();
+    EXPECT_TRUE(std::equal(unpacked.begin(), unpacked.end(), expected.begin(), expected.end()));
+    EXPECT_TRUE(std::equal(compressed.begin(), compressed.end(), expected.begin(), expected.end()));
+}
+
+}  // namespace
+
+TEST(CompressedVectorTest, SortedIdsTakeFewBytes) {
+    CompressedVector<uint64_t> compressed;
+    std::vector<uint64_t> expected;
+    uint64_t id = 1'000'000'000;
+    for (int i = 0; i < 100000; ++i) {
+        id += static_cast<uint64_t>(i % 7);
+        compressed.PushBack(id);
+        expected.push_back(id);
+    }
+    ExpectSameElements(compressed, expected);
+    // Разности внутри блока занимают не больше 10 бит вместо 64
+    EXPECT_LT(compressed.MemoryUsage(), expected.size() * 2);
+}
+
+TEST(CompressedVectorTest, EveryBitWidthRoundTrips) {
+    std::mt19937_64 random(7);
+    CompressedVector<int64_t> compressed;
+    std::vector<int64_t> expected;
+    // Блок с шириной разностей bits для каждой ширины от 0 до 64
+    for (unsigned bits = 0; bits <= 64; ++bits) {
+        for (size_t i = 0; i < CompressedVector<int64_t>::kBlockSize; ++i) {
+            const uint64_t mask = bits == 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << bits) - 1;
+            const auto value = static_cast<int64_t>(random() & mask) + (bits == 64 ? 0 : -5);
+            compressed.PushBack(value);
+            expected.push_back(value);
+        }
+    }
+    compressed.PushBack(std::numeric_limits<int64_t>::min());
+    expected.push_back(std::numeric_limits<int64_t>::min());
+    ExpectSameElements(compressed, expected);
+}
+
+TEST(CompressedVectorTest, SmallTypesAndClear) {
+    CompressedVector<int8_t> compressed;
+    std::vector<int8_t> expected;
+    for (int i = 0; i < 1000; ++i) {
+        const auto value = static_cast<int8_t>(i * 37);
+        compressed.PushBack(value);
+        expected.push_back(value);
+    }
+    ExpectSameElements(compressed, expected);
+    compressed.Clear();
+    EXPECT_EQ(compressed.Size(), 0u);
+    EXPECT_EQ(compressed.BlockCount(), 0u);
+    compressed.PushBack(1);
+    ExpectSameElements(compressed, { 1 });
+}
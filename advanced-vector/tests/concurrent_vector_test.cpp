@@ -0,0 +1,164 @@
+#include "concurrent_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ThrowingOnNegative {
+    explicit ThrowingOnNegative(int v)
+        : value(v) {
+        if (v < 0) {
+            throw std::runtime_error("negative");
+        }
+    }
+
+    int value;
+};
+
+}  // namespace
+
+TEST(ConcurrentVectorTest, EmplaceBackKeepsAddresses) {
+    ConcurrentVector<std::string, 4> v;
+    std::vector<const std::string*> addresses;
+    for (int i = 0; i < 100; ++i) {
+        addresses.push_back(&v.EmplaceBack(std::to_string(i)));
+    }
+    ASSERT_EQ(v.Size(), 100u);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(&v[i], addresses[i]);
+        EXPECT_EQ(v[i], std::to_string(i));
+    }
+    EXPECT_EQ(v.TryGet(100), nullptr);
+}
+
+TEST(ConcurrentVectorTest, ConcurrentEmplaceBackWithReaders) {
+    constexpr int kWriters = 4;
+    constexpr int kPerWriter = 20000;
+    ConcurrentVector<std::pair<int, int>, 8> v;
+    std::atomic<bool> done{ false };
+    std::atomic<int> bad_reads{ 0 };
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                const size_t size = v.Size();
+                for (size_t i = 0; i < size; i += 97) {
+                    if (const auto* item = v.TryGet(i)) {
+                        if (item->first < 0 || item->first >= kWriters || item->second < 0 || item->second >= kPerWriter) {
+                            bad_reads.fetch_add(1);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&v, w] {
+            for (int i = 0; i < kPerWriter; ++i) {
+                auto& item = v.EmplaceBack(w, i);
+                ASSERT_EQ(item.first, w);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(bad_reads.load(), 0);
+    ASSERT_EQ(v.Size(), size_t{ kWriters * kPerWriter });
+    // Каждый поток добавил свои элементы ровно один раз и в своём порядке
+    std::vector<int> next(kWriters, 0);
+    size_t visited = 0;
+    v.ForEach([&](const std::pair<int, int>& item) {
+        EXPECT_EQ(item.second, next[item.first]++);
+        ++visited;
+    });
+    EXPECT_EQ(visited, v.Size());
+    for (int w = 0; w < kWriters; ++w) {
+        EXPECT_EQ(next[w], kPerWriter);
+    }
+}
+
+TEST(ConcurrentVectorTest, ConcurrentReserve) {
+    ConcurrentVector<int, 2> v;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&v] {
+            v.Reserve(1000);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < 1000; ++i) {
+        v.PushBack(i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(v[i], i);
+    }
+}
+
+TEST(ConcurrentVectorTest, ThrowingConstructorLeavesSlotNotReady) {
+    ConcurrentVector<ThrowingOnNegative, 4> v;
+    v.EmplaceBack(1);
+    EXPECT_THROW(v.EmplaceBack(-1), std::runtime_error);
+    v.EmplaceBack(3);
+    ASSERT_EQ(v.Size(), 3u);
+    EXPECT_EQ(v.TryGet(1), nullptr);
+    ASSERT_NE(v.TryGet(2), nullptr);
+    EXPECT_EQ(v.TryGet(2)->value, 3);
+
+    int sum = 0;
+    v.ForEach([&](const ThrowingOnNegative& item) {
+        sum += item.value;
+    });
+    EXPECT_EQ(sum, 4);
+}
+
+TEST(ConcurrentVectorTest, ClearDestroysElementsAndKeepsChunks) {
+    auto counter = std::make_shared<int>(0);
+    ConcurrentVector<std::shared_ptr<int>, 4> v;
+    for (int i = 0; i < 50; ++i) {
+        v.PushBack(counter);
+    }
+    EXPECT_EQ(counter.use_count(), 51);
+    const auto* first = &v[0];
+    v.Clear();
+    EXPECT_EQ(counter.use_count(), 1);
+    EXPECT_EQ(v.Size(), 0u);
+    EXPECT_EQ(&v.EmplaceBack(counter), first);
+}
+
+TEST(ConcurrentVectorTest, MoveTransfersElements) {
+    ConcurrentVector<std::string> v;
+    v.EmplaceBack("a");
+    v.EmplaceBack("b");
+    const std::string* a = &v[0];
+
+    ConcurrentVector<std::string> moved(std::move(v));
+    EXPECT_EQ(v.Size(), 0u);
+    ASSERT_EQ(moved.Size(), 2u);
+    EXPECT_EQ(&moved[0], a);
+    EXPECT_EQ(moved[1], "b");
+
+    ConcurrentVector<std::string> assigned;
+    assigned.EmplaceBack("c");
+    assigned = std::move(moved);
+    ASSERT_EQ(assigned.Size(), 2u);
+    EXPECT_EQ(assigned[0], "a");
+}
@@ -0,0 +1,93 @@
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <utility>
+
+// Тест собирается в C++20: в C++17 операции векторов не constexpr
+#ifndef __cpp_lib_constexpr_dynamic_alloc
+#error "constexpr_test must be built as C++20"
+#endif
+
+namespace {
+
+constexpr int SumOfSquares(int n) {
+    Vector<int> v;
+    for (int i = 1; i <= n; ++i) {
+        v.PushBack(i * i);
+    }
+    return std::accumulate(v.begin(), v.end(), 0);
+}
+
+// Вставка, удаление, рост и копирование при вычислении на этапе компиляции.
+// Результат - содержимое вектора, скопированное в std::array
+constexpr std::array<int, 6> EditVector() {
+    Vector<int> v;
+    v.Reserve(2);
+    for (int i = 0; i < 5; ++i) {
+        v.EmplaceBack(i);
+    }
+    v.Insert(v.begin(), 10);
+    v.Insert(v.begin() + 3, v[0]);
+    v.Erase(v.begin() + 1);
+    Vector<int> copy = v;
+    copy.PopBack();
+    copy.Resize(6);
+    copy[5] = 7;
+    Vector<int> moved = std::move(copy);
+    moved.ShrinkToFit();
+    std::array<int, 6> result{};
+    for (size_t i = 0; i < moved.Size(); ++i) {
+        result[i] = moved[i];
+    }
+    return result;
+}
+
+// Вектор из объектов с нетривиальным деструктором: элементы сами владеют памятью
+constexpr size_t NestedSizes() {
+    Vector<Vector<int>> rows;
+    for (int i = 0; i < 4; ++i) {
+        rows.EmplaceBack(static_cast<size_t>(i + 1));
+    }
+    rows.Erase(rows.begin());
+    size_t total = 0;
+    for (const Vector<int>& row : rows) {
+        total += row.Size();
+    }
+    return total;
+}
+
+constexpr std::array<int, 4> FillStaticVector() {
+    StaticVector<int, 4> v;
+    v.PushBack(3);
+    v.PushBack(1);
+    v.Insert(v.begin() + 1, 2);
+    v.EmplaceBack(4);
+    v.Erase(v.begin());
+    v.PushBack(5);
+    std::array<int, 4> result{};
+    for (size_t i = 0; i < v.Size(); ++i) {
+        result[i] = v[i];
+    }
+    return result;
+}
+
+}  // namespace
+
+static_assert(SumOfSquares(3) == 14);
+static_assert(SumOfSquares(100) == 338350);
+static_assert(EditVector() == std::array<int, 6>{ 10, 1, 10, 2, 3, 7 });
+static_assert(NestedSizes() == 2 + 3 + 4);
+static_assert(FillStaticVector() == std::array<int, 4>{ 2, 1, 4, 5 });
+
+// Те же функции при обычном вызове дают тот же результат
+TEST(ConstexprTest, RuntimeResultsMatchCompileTime) {
+    volatile int n = 100;
+    EXPECT_EQ(SumOfSquares(n), 338350);
+    EXPECT_EQ(EditVector(), (std::array<int, 6>{ 10, 1, 10, 2, 3, 7 }));
+    EXPECT_EQ(NestedSizes(), 9u);
+    EXPECT_EQ(FillStaticVector(), (std::array<int, 4>{ 2, 1, 4, 5 }));
+}
@@ -0,0 +1,76 @@
+#include "cow_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(CowVectorTest, SnapshotsDoNotSeeLaterWrites) {
+    CowVector<std::string, 4> v;
+    for (int i = 0; i < 20; ++i) {
+        v.PushBack(std::to_string(i));
+    }
+    const CowVector<std::string, 4> snapshot = v;
+    v[5] = "five";
+    v.PushBack("20");
+    v.Erase(v.begin() + 10);
+
+    ASSERT_EQ(snapshot.Size(), 20u);
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(snapshot[i], std::to_string(i));
+    }
+    ASSERT_EQ(v.Size(), 20u);
+    EXPECT_EQ(v[5], "five");
+    EXPECT_EQ(v[10], "11");
+    EXPECT_EQ(std::as_const(v)[19], "20");
+}
+
+TEST(CowVectorTest, WritesCloneOnlyTouchedChunks) {
+    CowVector<int, 4> v;
+    for (int i = 0; i < 16; ++i) {
+        v.PushBack(i);
+    }
+    const CowVector<int, 4> snapshot = v;
+    v[1] = 100;
+    // Блоки, которых запись не коснулась, по-прежнему общие
+    EXPECT_NE(&std::as_const(v)[1], &snapshot[1]);
+    EXPECT_EQ(&std::as_const(v)[8], &snapshot[8]);
+    EXPECT_EQ(snapshot[1], 1);
+}
+
+TEST(CowVectorTest, ReferenceTakenAfterCopyIsIsolated) {
+    CowVector<int, 4> v;
+    v.PushBack(0);
+    const CowVector<int, 4> snapshot = v;
+    // Ссылка, полученная после копирования, указывает в уже отделённый блок
+    int& item = v[0];
+    item = 1;
+    EXPECT_EQ(snapshot[0], 0);
+    EXPECT_EQ(std::as_const(v)[0], 1);
+}
+
+TEST(CowVectorTest, CopiesAreIndependentAcrossThreads) {
+    CowVector<int, 64> v;
+    for (int i = 0; i < 10000; ++i) {
+        v.PushBack(i);
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([copy = v, t]() mutable {
+            for (size_t i = 0; i < copy.Size(); i += 7) {
+                copy[i] = t;
+            }
+            for (size_t i = 0; i < copy.Size(); ++i) {
+                ASSERT_EQ(std::as_const(copy)[i], i % 7 == 0 ? t : static_cast<int>(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < v.Size(); ++i) {
+        ASSERT_EQ(std::as_const(v)[i], static_cast<int>(i));
+    }
+}
@@ -0,0 +1,97 @@
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+static_assert(kVectorHardened, "hardened_vector_test must be built with ADVANCED_VECTOR_HARDENED");
+static_assert(!std::is_pointer_v<Vector<int>::iterator>);
+
+namespace {
+
+class HardenedVectorDeathTest : public testing::Test {
+protected:
+    void SetUp() override {
+        testing::FLAGS_gtest_death_test_style = "threadsafe";
+    }
+};
+
+}  // namespace
+
+TEST(HardenedVectorTest, ValidUseIsNotReported) {
+    Vector<std::string> v;
+    for (int i = 0; i < 100; ++i) {
+        v.PushBack(std::to_string(i));
+    }
+    auto it = v.Erase(v.begin() + 10, v.begin() + 20);
+    it = v.Insert(it, "inserted");
+    EXPECT_EQ(*it, "inserted");
+    EXPECT_EQ(it - v.begin(), 10);
+    size_t count = 0;
+    for (const std::string& item : v) {
+        count += item.empty() ? 0 : 1;
+    }
+    EXPECT_EQ(count, 91u);
+
+    // Итератор переживает изменения без смены буфера
+    v.Reserve(v.Size() + 1);
+    const auto first = v.begin();
+    v.PushBack("tail");
+    EXPECT_EQ(*first, "0");
+}
+
+TEST_F(HardenedVectorDeathTest, IndexOutOfRange) {
+    Vector<int> v(3);
+    EXPECT_DEATH(static_cast<void>(v[3]), "index out of range");
+}
+
+TEST_F(HardenedVectorDeathTest, IteratorAfterGrowth) {
+    Vector<int> v(4);
+    v.ShrinkToFit();
+    const auto it = v.begin();
+    EXPECT_DEATH(
+        {
+            v.PushBack(1);
+            static_cast<void>(*it);
+        },
+        "iterator used after the vector buffer was replaced");
+}
+
+TEST_F(HardenedVectorDeathTest, IteratorPastEnd) {
+    Vector<int> v(4);
+    EXPECT_DEATH(static_cast<void>(*v.end()), "iterator out of range");
+}
+
+TEST_F(HardenedVectorDeathTest, EraseWithForeignIterator) {
+    Vector<int> v(4);
+    Vector<int> other(4);
+    EXPECT_DEATH(v.Erase(other.begin()), "does not belong to the vector");
+}
+
+TEST_F(HardenedVectorDeathTest, InsertWithStaleIterator) {
+    Vector<int> v(4);
+    const auto stale = v.begin();
+    v.Reserve(100);
+    EXPECT_DEATH(v.Insert(stale, 1), "does not belong to the vector or was invalidated");
+}
+
+TEST_F(HardenedVectorDeathTest, IteratorsOfDifferentVectorsCompared) {
+    Vector<int> v(4);
+    Vector<int> other(4);
+    EXPECT_DEATH(static_cast<void>(v.begin() == other.begin()), "iterators of different vectors compared");
+}
+
+#ifdef ADVANCED_VECTOR_ASAN
+// Под AddressSanitizer неиспользуемая вместимость буфера недоступна
+TEST_F(HardenedVectorDeathTest, ReadPastSizeIsContainerOverflow) {
+    Vector<int> v;
+    v.Reserve(16);
+    v.PushBack(1);
+    const volatile int* data = v.Data();
+    EXPECT_DEATH(static_cast<void>(data[1]), "container-overflow");
+    v.PushBack(2);
+    EXPECT_EQ(data[1], 2);
+}
+#endif
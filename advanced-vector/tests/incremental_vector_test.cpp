@@ -0,0 +1,97 @@
+#include "incremental_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename Vector>
+std::vector<typename Vector::allocator_type::value_type> Collect(const Vector& v) {
+    std::vector<typename Vector::allocator_type::value_type> result;
+    v.ForEachChunk([&result](const auto* first, size_t count) {
+        result.insert(result.end(), first, first + count);
+    });
+    return result;
+}
+
+}  // namespace
+
+TEST(IncrementalVectorTest, MigratesGraduallyAndKeepsOrder) {
+    IncrementalVector<std::string> v;
+    std::vector<std::string> expected;
+    bool saw_migration = false;
+    for (int i = 0; i < 5000; ++i) {
+        v.PushBack(std::to_string(i));
+        expected.push_back(std::to_string(i));
+        saw_migration = saw_migration || v.IsMigrating();
+        if (i % 97 == 0) {
+            ASSERT_EQ(Collect(v), expected);
+        }
+    }
+    EXPECT_TRUE(saw_migration);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(v[i], expected[i]);
+    }
+    v.FinishMigration();
+    EXPECT_FALSE(v.IsMigrating());
+    EXPECT_EQ(Collect(v), expected);
+}
+
+TEST(IncrementalVectorTest, GrowsByPolicy) {
+    IncrementalVector<int, std::allocator<int>, OneAndHalfGrowth> v;
+    std::vector<size_t> capacities;
+    for (int i = 0; i < 100; ++i) {
+        if (v.Size() == v.Capacity()) {
+            v.PushBack(i);
+            capacities.push_back(v.Capacity());
+        }
+        else {
+            v.PushBack(i);
+        }
+    }
+    const std::vector<size_t> expected = { 1, 2, 3, 4, 6, 9, 13, 19, 28, 42, 63, 94, 141 };
+    EXPECT_EQ(capacities, expected);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(v[i], i);
+    }
+}
+
+TEST(IncrementalVectorTest, LinearGrowthFinishesMigrationBeforeNextGrowth) {
+    // После 64 байт вместимость растёт на 4 элемента, и перенос не успевает завершиться
+    IncrementalVector<int, std::allocator<int>, CappedLinearGrowth<64, 16>, 1> v;
+    size_t capacity = 0;
+    for (int i = 0; i < 1000; ++i) {
+        v.PushBack(i);
+        if (v.Capacity() != capacity && capacity >= 16) {
+            ASSERT_EQ(v.Capacity(), capacity + 4);
+        }
+        capacity = v.Capacity();
+    }
+    EXPECT_EQ(capacity, 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(v[i], i);
+    }
+}
+
+TEST(IncrementalVectorTest, PopBackDuringMigration) {
+    IncrementalVector<std::string, std::allocator<std::string>, DoublingGrowth, 1> v;
+    for (int i = 0; i < 65; ++i) {
+        v.PushBack(std::to_string(i));
+    }
+    ASSERT_TRUE(v.IsMigrating());
+    for (int i = 64; i >= 10; --i) {
+        ASSERT_EQ(v[i], std::to_string(i));
+        v.PopBack();
+    }
+    EXPECT_FALSE(v.IsMigrating());
+    ASSERT_EQ(v.Size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(v[i], std::to_string(i));
+    }
+
+    const auto copy = v;
+    EXPECT_EQ(Collect(copy), Collect(v));
+}
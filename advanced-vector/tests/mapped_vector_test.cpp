@@ -0,0 +1,140 @@
+#include "mapped_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <unistd.h>
+
+namespace {
+
+// Путь к временному файлу, который удаляется вместе с объектом
+class TempPath {
+public:
+    TempPath() {
+        char name[] = "/tmp/mapped_vector_testXXXXXX";
+        const int fd = mkstemp(name);
+        close(fd);
+        path_ = name;
+    }
+
+    TempPath(const TempPath&) = delete;
+    TempPath& operator=(const TempPath&) = delete;
+
+    ~TempPath() {
+        unlink(path_.c_str());
+    }
+
+    const std::string& Get() const {
+        return path_;
+    }
+
+private:
+    std::string path_;
+};
+
+struct Row {
+    int64_t id;
+    double value;
+};
+
+void Fill(const std::string& path, int count) {
+    auto v = MappedVector<Row>::Create(path);
+    for (int i = 0; i < count; ++i) {
+        v.PushBack({ i, i * 0.5 });
+    }
+    v.Flush();
+}
+
+}  // namespace
+
+// Вид только для чтения не даёт изменяемого доступа даже к неконстантному объекту
+static_assert(std::is_same_v<decltype(std::declval<MappedVectorView<Row>&>()[0]), const Row&>);
+static_assert(std::is_same_v<decltype(std::declval<MappedVectorView<Row>&>().begin()), const Row*>);
+
+TEST(MappedVectorTest, PersistsAcrossReopen) {
+    const TempPath path;
+    Fill(path.Get(), 10000);
+
+    auto v = MappedVector<Row>::Open(path.Get(), MappedMode::kReadWrite);
+    ASSERT_EQ(v.Size(), 10000u);
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(v[i].id, i);
+        ASSERT_EQ(v[i].value, i * 0.5);
+    }
+    v[5].value = -1;
+    v.PushBack({ 10000, 0 });
+    v.Flush();
+
+    const auto view = MappedVectorView<Row>::Open(path.Get());
+    ASSERT_EQ(view.Size(), 10001u);
+    EXPECT_EQ(view[5].value, -1);
+    EXPECT_EQ(view[10000].id, 10000);
+}
+
+TEST(MappedVectorTest, ViewReadsThroughNonConstObject) {
+    const TempPath path;
+    Fill(path.Get(), 100);
+
+    auto view = MappedVectorView<Row>::Open(path.Get());
+    int64_t sum = 0;
+    for (const Row& row : view) {
+        sum += row.id;
+    }
+    EXPECT_EQ(sum, 99 * 100 / 2);
+    EXPECT_EQ(view[42].id, 42);
+}
+
+TEST(MappedVectorTest, CopyOnWriteLeavesFileUntouched) {
+    const TempPath path;
+    Fill(path.Get(), 100);
+    {
+        auto v = MappedVector<Row>::Open(path.Get(), MappedMode::kCopyOnWrite);
+        v[0].id = -1;
+        // Рост за пределы файла переносит элементы в анонимную память
+        for (int i = 0; i < 10000; ++i) {
+            v.PushBack({ 100 + i, 0 });
+        }
+        EXPECT_EQ(v[0].id, -1);
+        EXPECT_EQ(v[5000].id, 5000);
+    }
+    const auto view = MappedVectorView<Row>::Open(path.Get());
+    ASSERT_EQ(view.Size(), 100u);
+    EXPECT_EQ(view[0].id, 0);
+}
+
+TEST(MappedVectorTest, InsertAndErase) {
+    const TempPath path;
+    auto v = MappedVector<int>::Create(path.Get());
+    for (int i = 0; i < 10; ++i) {
+        v.PushBack(i);
+    }
+    v.Insert(v.begin(), v[9]);
+    v.Insert(v.begin() + 5, -5);
+    v.Erase(v.begin() + 1, v.begin() + 3);
+    v.Erase(v.end() - 1);
+
+    const int expected[] = { 9, 2, 3, -5, 4, 5, 6, 7, 8 };
+    ASSERT_EQ(v.Size(), std::size(expected));
+    EXPECT_TRUE(std::equal(v.begin(), v.end(), std::begin(expected)));
+}
+
+TEST(MappedVectorTest, RejectsForeignFiles) {
+    const TempPath path;
+    Fill(path.Get(), 10);
+    EXPECT_THROW(MappedVector<int>::Open(path.Get(), MappedMode::kReadWrite), std::runtime_error);
+    EXPECT_THROW(MappedVectorView<int>::Open(path.Get()), std::runtime_error);
+
+    const TempPath empty;
+    EXPECT_THROW(MappedVectorView<Row>::Open(empty.Get()), std::runtime_error);
+    EXPECT_THROW(MappedVectorView<Row>::Open(empty.Get() + ".missing"), std::system_error);
+}
@@ -0,0 +1,205 @@
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Считает живые объекты
+struct Tracked {
+    Tracked() {
+        if (throw_at.fetch_sub(1) == 1) {
+            throw std::runtime_error("construction failed");
+        }
+        live.fetch_add(1);
+    }
+
+    Tracked(const Tracked& other)
+        : Tracked() {
+        value = other.value;
+    }
+
+    ~Tracked() {
+        live.fetch_sub(1);
+    }
+
+    int value = 0;
+
+    static inline std::atomic<long> live{ 0 };
+    // Какой по счёту конструктор выбросит исключение; не больше нуля - ни один
+    static inline std::atomic<long> throw_at{ 0 };
+};
+
+ParallelPolicy MakePolicy(ParallelExecutor& executor, size_t threshold) {
+    ParallelPolicy policy;
+    policy.executor = &executor;
+    policy.threshold = threshold;
+    return policy;
+}
+
+// Выполняет задачи в вызывающем потоке и считает, сколько частей работы получил.
+// Пул потоков мог бы выполнить все части одним потоком, а счётчик от этого не зависит
+class CountingExecutor : public ParallelExecutor {
+public:
+    void Run(size_t count, const std::function<void(size_t)>& task) override {
+        chunks += count;
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+    }
+
+    size_t GetConcurrency() const noexcept override {
+        return 4;
+    }
+
+    size_t chunks = 0;
+};
+
+class ThrowingExecutor : public ParallelExecutor {
+public:
+    void Run(size_t, const std::function<void(size_t)>&) override {
+        throw std::runtime_error("executor failed");
+    }
+
+    size_t GetConcurrency() const noexcept override {
+        return 4;
+    }
+};
+
+class ParallelTest : public testing::Test {
+protected:
+    void SetUp() override {
+        Tracked::live = 0;
+        Tracked::throw_at = 0;
+    }
+
+    void TearDown() override {
+        EXPECT_EQ(Tracked::live.load(), 0);
+    }
+};
+
+}  // namespace
+
+TEST(ThreadExecutorTest, RunsEveryTaskOnceOnReusedThreads) {
+    ThreadExecutor executor(4);
+    std::set<std::thread::id> threads;
+    std::mutex mutex;
+    for (int round = 0; round < 100; ++round) {
+        std::vector<std::atomic<int>> calls(10);
+        executor.Run(calls.size(), [&](size_t i) {
+            calls[i].fetch_add(1);
+            std::lock_guard lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        });
+        for (const auto& count : calls) {
+            ASSERT_EQ(count.load(), 1);
+        }
+    }
+    // Потоки пула переживают вызовы Run, а не создаются заново
+    EXPECT_LE(threads.size(), 4u);
+}
+
+TEST(ThreadExecutorTest, NestedAndConcurrentRuns) {
+    ThreadExecutor executor(3);
+    std::atomic<int> total{ 0 };
+    const auto nested = [&](size_t) {
+        executor.Run(5, [&](size_t) {
+            total.fetch_add(1);
+        });
+    };
+    std::thread other([&] {
+        for (int i = 0; i < 50; ++i) {
+            executor.Run(4, nested);
+        }
+    });
+    for (int i = 0; i < 50; ++i) {
+        executor.Run(4, nested);
+    }
+    other.join();
+    EXPECT_EQ(total.load(), 2 * 50 * 4 * 5);
+}
+
+TEST_F(ParallelTest, ConstructCopyResizeAndClear) {
+    ThreadExecutor executor(4);
+    const ParallelPolicy policy = MakePolicy(executor, 10);
+    {
+        Vector<Tracked> v(1000, policy);
+        EXPECT_EQ(Tracked::live.load(), 1000);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            v[i].value = static_cast<int>(i);
+        }
+        Vector<Tracked> copy(v, policy);
+        ASSERT_EQ(copy.Size(), 1000u);
+        for (size_t i = 0; i < copy.Size(); ++i) {
+            ASSERT_EQ(copy[i].value, static_cast<int>(i));
+        }
+        copy.Resize(37, policy);
+        copy.Resize(500, policy);
+        EXPECT_EQ(copy[36].value, 36);
+        EXPECT_EQ(copy[37].value, 0);
+        EXPECT_EQ(Tracked::live.load(), 1500);
+        v.Clear(policy, true);
+        EXPECT_EQ(v.Capacity(), 0u);
+        EXPECT_EQ(Tracked::live.load(), 500);
+    }
+}
+
+TEST_F(ParallelTest, FailedChunkDestroysConstructedChunks) {
+    ThreadExecutor executor(4);
+    const ParallelPolicy policy = MakePolicy(executor, 10);
+    Vector<Tracked> v(100);
+    Tracked::throw_at = 150;
+    EXPECT_THROW(v.Resize(400, policy), std::runtime_error);
+    EXPECT_EQ(v.Size(), 100u);
+    EXPECT_EQ(Tracked::live.load(), 100);
+
+    Tracked::throw_at = 300;
+    EXPECT_THROW((Vector<Tracked>(1000, policy)), std::runtime_error);
+    EXPECT_EQ(Tracked::live.load(), 100);
+    Tracked::throw_at = 0;
+}
+
+TEST_F(ParallelTest, MoreChunksThanElements) {
+    ThreadExecutor executor(4);
+    Vector<Tracked> v(5);
+    v.Clear(MakePolicy(executor, 1));
+    EXPECT_EQ(Tracked::live.load(), 0);
+    Vector<Tracked> w(5, MakePolicy(executor, 1));
+    EXPECT_EQ(Tracked::live.load(), 5);
+}
+
+TEST_F(ParallelTest, DestructorUsesDestructorPolicy) {
+    CountingExecutor executor;
+    const ParallelPolicy policy = MakePolicy(executor, 1000);
+    SetDestructorPolicy(&policy);
+    {
+        Vector<Tracked> v(100000);
+    }
+    SetDestructorPolicy(nullptr);
+    EXPECT_EQ(Tracked::live.load(), 0);
+    EXPECT_EQ(executor.chunks, 4u);
+
+    {
+        Vector<Tracked> v(100000);
+    }
+    EXPECT_EQ(executor.chunks, 4u);
+}
+
+TEST(ParallelDeathTest, ThrowingExecutorTerminatesDestruction) {
+    testing::FLAGS_gtest_death_test_style = "threadsafe";
+    ThrowingExecutor executor;
+    EXPECT_DEATH(
+        {
+            Vector<Tracked> v(100);
+            v.Clear(MakePolicy(executor, 1));
+        },
+        "");
+}
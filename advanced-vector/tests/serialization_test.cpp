@@ -0,0 +1,226 @@
+#include "serialization.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+namespace {
+
+// Считает выделения, чтобы проверить, что чтение выделяет память один раз
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {  // NOLINT(google-explicit-constructor)
+    }
+
+    T* allocate(size_t n) {
+        ++allocations;
+        largest = std::max(largest, n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    friend bool operator==(const CountingAllocator&, const CountingAllocator&) noexcept {
+        return true;
+    }
+
+    friend bool operator!=(const CountingAllocator&, const CountingAllocator&) noexcept {
+        return false;
+    }
+
+    static inline size_t allocations = 0;
+    static inline size_t largest = 0;
+};
+
+// Тривиально копируемый тип без конструктора по умолчанию
+struct Point {
+    Point(int x_, int y_)
+        : x(x_)
+        , y(y_) {
+    }
+
+    int x;
+    int y;
+};
+
+template <typename Left, typename Right>
+bool Equal(const Left& left, const Right& right) {
+    return std::equal(left.begin(), left.end(), right.begin(), right.end());
+}
+
+class TempFile {
+public:
+    TempFile()
+        : file_(std::tmpfile()) {
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    ~TempFile() {
+        std::fclose(file_);
+    }
+
+    int Fd() const {
+        return fileno(file_);
+    }
+
+    void Rewind() const {
+        lseek(Fd(), 0, SEEK_SET);
+    }
+
+private:
+    std::FILE* file_;
+};
+
+}  // namespace
+
+TEST(SerializationTest, RoundTripThroughFile) {
+    Vector<int> ints;
+    for (int i = 0; i < 100000; ++i) {
+        ints.PushBack(i * 3);
+    }
+    Vector<std::string> strings;
+    for (int i = 0; i < 300; ++i) {
+        strings.PushBack(std::string(i % 70, static_cast<char>('a' + i % 26)));
+    }
+    Vector<Vector<int>> nested;
+    nested.EmplaceBack(3);
+    nested[0][2] = 7;
+    nested.EmplaceBack();
+
+    TempFile file;
+    {
+        VectorWriter writer(file.Fd());
+        writer.Write(ints);
+        writer.Write(strings);
+        writer.Write(nested);
+        writer.Flush();
+    }
+    file.Rewind();
+
+    VectorReader reader(file.Fd());
+    Vector<int> ints_read(5);
+    Vector<std::string> strings_read;
+    Vector<Vector<int>> nested_read;
+    reader.Read(ints_read);
+    reader.Read(strings_read);
+    reader.Read(nested_read);
+    EXPECT_TRUE(Equal(ints_read, ints));
+    EXPECT_TRUE(Equal(strings_read, strings));
+    ASSERT_EQ(nested_read.Size(), 2u);
+    EXPECT_TRUE(Equal(nested_read[0], nested[0]));
+    EXPECT_EQ(nested_read[1].Size(), 0u);
+
+    Vector<int> past_end;
+    EXPECT_THROW(reader.Read(past_end), std::runtime_error);
+}
+
+TEST(SerializationTest, RawReadAllocatesOnce) {
+    using CountingVector = Vector<uint64_t, CountingAllocator<uint64_t>>;
+    CountingVector written;
+    for (uint64_t i = 0; i < 300000; ++i) {
+        written.PushBack(i * i);
+    }
+    TempFile file;
+    {
+        VectorWriter writer(file.Fd());
+        writer.Write(written);
+        writer.Flush();
+    }
+    file.Rewind();
+
+    CountingAllocator<uint64_t>::allocations = 0;
+    CountingVector read;
+    VectorReader(file.Fd()).Read(read);
+    EXPECT_EQ(CountingAllocator<uint64_t>::allocations, 1u);
+    EXPECT_EQ(read.Capacity(), written.Size());
+    EXPECT_TRUE(Equal(read, written));
+}
+
+TEST(SerializationTest, ElementsWithoutDefaultConstructor) {
+    Vector<Point> points;
+    points.EmplaceBack(1, 2);
+    points.EmplaceBack(3, 4);
+    TempFile file;
+    {
+        VectorWriter writer(file.Fd());
+        writer.Write(points);
+        writer.Flush();
+    }
+    file.Rewind();
+
+    Vector<Point> read;
+    VectorReader(file.Fd()).Read(read);
+    ASSERT_EQ(read.Size(), 2u);
+    EXPECT_EQ(read[1].x, 3);
+    EXPECT_EQ(read[1].y, 4);
+}
+
+TEST(SerializationTest, CorruptCountIsRejectedBeforeAllocation) {
+    using CountingVector = Vector<uint32_t, CountingAllocator<uint32_t>>;
+    CountingVector written;
+    for (uint32_t i = 0; i < 10; ++i) {
+        written.PushBack(i);
+    }
+    TempFile file;
+    {
+        VectorWriter writer(file.Fd());
+        writer.Write(written);
+        writer.Flush();
+    }
+    // Длина в заголовке обещает терабайты данных
+    const uint64_t count = uint64_t{ 1 } << 40;
+    ASSERT_EQ(pwrite(file.Fd(), &count, sizeof(count), offsetof(detail::SerializedVectorHeader, count)),
+              static_cast<ssize_t>(sizeof(count)));
+    file.Rewind();
+
+    CountingAllocator<uint32_t>::largest = 0;
+    CountingVector read;
+    read.PushBack(1);
+    EXPECT_THROW(VectorReader(file.Fd()).Read(read), std::runtime_error);
+    EXPECT_EQ(read.Size(), 0u);
+    EXPECT_LT(CountingAllocator<uint32_t>::largest, size_t{ 1 } << 20);
+}
+
+TEST(SerializationTest, PipeWithLimit) {
+    Vector<int> written;
+    for (int i = 0; i < 1000; ++i) {
+        written.PushBack(i);
+    }
+    // Вектор целиком помещается в буфер канала, поэтому пишется без второго потока
+    const auto write_to_pipe = [&written](int* fds) {
+        ASSERT_EQ(pipe(fds), 0);
+        VectorWriter writer(fds[1]);
+        writer.Write(written);
+        writer.Flush();
+        close(fds[1]);
+    };
+
+    int fds[2];
+    write_to_pipe(fds);
+    Vector<int> read;
+    VectorReader(fds[0], written.Size() * sizeof(int)).Read(read);
+    close(fds[0]);
+    EXPECT_TRUE(Equal(read, written));
+
+    write_to_pipe(fds);
+    Vector<int> rejected;
+    EXPECT_THROW(VectorReader(fds[0], written.Size() * sizeof(int) - 1).Read(rejected), std::runtime_error);
+    close(fds[0]);
+}
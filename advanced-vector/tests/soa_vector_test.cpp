@@ -0,0 +1,135 @@
+#include "soa_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+// Считает живые объекты; перемещение или копирование с номером fail_at выбрасывает исключение
+struct Fragile {
+    explicit Fragile(int v = 0)
+        : value(v) {
+        ++live;
+    }
+
+    Fragile(const Fragile& other)
+        : value(other.value) {
+        Tick();
+        ++live;
+    }
+
+    Fragile(Fragile&& other) noexcept(false)
+        : value(other.value) {
+        Tick();
+        other.value = -1;
+        ++live;
+    }
+
+    ~Fragile() {
+        --live;
+    }
+
+    static void Tick() {
+        if (fail_at > 0 && --fail_at == 0) {
+            throw std::runtime_error("relocation failed");
+        }
+    }
+
+    int value;
+
+    static inline long live = 0;
+    static inline long fail_at = 0;
+};
+
+// Только перемещаемый тип, перемещение которого может выбросить исключение
+struct FragileMoveOnly : Fragile {
+    using Fragile::Fragile;
+
+    FragileMoveOnly(const FragileMoveOnly&) = delete;
+    FragileMoveOnly(FragileMoveOnly&&) = default;
+};
+
+class SoAVectorTest : public testing::Test {
+protected:
+    void SetUp() override {
+        Fragile::live = 0;
+        Fragile::fail_at = 0;
+    }
+
+    void TearDown() override {
+        EXPECT_EQ(Fragile::live, 0);
+    }
+};
+
+}  // namespace
+
+TEST_F(SoAVectorTest, RowsAndColumns) {
+    SoAVector<int, double, std::string> rows;
+    for (int i = 0; i < 100; ++i) {
+        rows.EmplaceBack(i, i * 0.5, std::to_string(i));
+    }
+    ASSERT_EQ(rows.Size(), 100u);
+    auto [id, price, name] = rows[42];
+    EXPECT_EQ(id, 42);
+    EXPECT_EQ(price, 21.0);
+    EXPECT_EQ(name, "42");
+    name = "changed";
+    EXPECT_EQ(rows.Column<2>()[42], "changed");
+
+    double sum = 0;
+    for (double value : rows.Column<1>()) {
+        sum += value;
+    }
+    EXPECT_EQ(sum, 0.5 * 99 * 100 / 2);
+
+    SoAVector<int, double, std::string> copy(rows);
+    rows.Resize(10);
+    rows.PopBack();
+    EXPECT_EQ(rows.Size(), 9u);
+    EXPECT_EQ(copy.Size(), 100u);
+    EXPECT_EQ(std::get<2>(copy[99]), "99");
+}
+
+TEST_F(SoAVectorTest, FailedCopyKeepsRows) {
+    SoAVector<std::string, Fragile> rows;
+    for (int i = 0; i < 4; ++i) {
+        rows.EmplaceBack(std::to_string(i), Fragile(i));
+    }
+    // Fragile копируется при росте: третье копирование не удаётся, и строки остаются прежними
+    Fragile::fail_at = 3;
+    EXPECT_THROW(rows.Reserve(100), std::runtime_error);
+    ASSERT_EQ(rows.Size(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(std::get<0>(rows[i]), std::to_string(i));
+        EXPECT_EQ(std::get<1>(rows[i]).value, i);
+    }
+    EXPECT_EQ(Fragile::live, 4);
+}
+
+TEST_F(SoAVectorTest, FailedThrowingMoveLeavesConsistentRows) {
+    SoAVector<std::string, std::unique_ptr<int>, FragileMoveOnly> rows;
+    for (int i = 0; i < 4; ++i) {
+        rows.EmplaceBack(std::to_string(i), std::make_unique<int>(i), FragileMoveOnly(i));
+    }
+    const long live = Fragile::live;
+    Fragile::fail_at = 2;
+    EXPECT_THROW(rows.Reserve(100), std::runtime_error);
+    // Поля, перемещение которых не выбрасывает исключений, ещё не тронуты
+    ASSERT_EQ(rows.Size(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(std::get<0>(rows[i]), std::to_string(i));
+        ASSERT_NE(std::get<1>(rows[i]), nullptr);
+        EXPECT_EQ(*std::get<1>(rows[i]), i);
+    }
+    EXPECT_EQ(Fragile::live, live);
+
+    rows.Reserve(100);
+    EXPECT_EQ(rows.Size(), 4u);
+    EXPECT_EQ(*std::get<1>(rows[3]), 3);
+    EXPECT_EQ(Fragile::live, live);
+}
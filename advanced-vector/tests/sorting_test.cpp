@@ -0,0 +1,171 @@
+#include "sorting.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Маленький порог заставляет делить на части даже короткие векторы
+ParallelPolicy SmallThreshold(ParallelExecutor& executor, size_t threshold = 1) {
+    ParallelPolicy policy;
+    policy.executor = &executor;
+    policy.threshold = threshold;
+    return policy;
+}
+
+template <typename T>
+Vector<T> ToVector(const std::vector<T>& values) {
+    Vector<T> v;
+    for (const T& value : values) {
+        v.PushBack(value);
+    }
+    return v;
+}
+
+template <typename T>
+std::vector<T> ToStd(const Vector<T>& v) {
+    return std::vector<T>(v.begin(), v.end());
+}
+
+std::vector<std::string> RandomStrings(size_t count, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<std::string> result;
+    for (size_t i = 0; i < count; ++i) {
+        result.push_back(std::string(random() % 20 + 16, static_cast<char>('a' + random() % 26)));
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(ParallelSortTest, MoreChunksThanElements) {
+    ThreadExecutor executor(4);
+    Vector<int> v = ToVector<int>({ 5, 4, 3, 2, 1 });
+    ParallelSort(v, std::less<>(), SmallThreshold(executor));
+    EXPECT_EQ(ToStd(v), (std::vector<int>{ 1, 2, 3, 4, 5 }));
+}
+
+TEST(ParallelSortTest, SmallThresholdsMatchStdSort) {
+    std::mt19937 random(42);
+    for (size_t concurrency : { 2, 3, 4, 7 }) {
+        ThreadExecutor executor(concurrency);
+        for (size_t size = 0; size < 70; ++size) {
+            for (size_t threshold : { 1, 2, 5 }) {
+                std::vector<std::string> expected;
+                for (size_t i = 0; i < size; ++i) {
+                    expected.push_back(std::to_string(random() % 50));
+                }
+                Vector<std::string> v = ToVector(expected);
+                ParallelSort(v, std::less<>(), SmallThreshold(executor, threshold));
+                std::sort(expected.begin(), expected.end());
+                ASSERT_EQ(ToStd(v), expected) << "size " << size << ", threshold " << threshold;
+            }
+        }
+    }
+}
+
+TEST(ParallelSortTest, ComparatorTakingValuesKeepsElements) {
+    ThreadExecutor executor(4);
+    std::vector<std::string> expected = RandomStrings(40, 1);
+    Vector<std::string> v = ToVector(expected);
+    ParallelSort(
+        v,
+        [](std::string a, std::string b) {
+            return a < b;
+        },
+        SmallThreshold(executor));
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(ToStd(v), expected);
+}
+
+TEST(ParallelSortTest, ComparatorTakingMutableReferences) {
+    ThreadExecutor executor(3);
+    std::vector<std::string> expected = RandomStrings(30, 2);
+    Vector<std::string> v = ToVector(expected);
+    ParallelSort(
+        v,
+        [](std::string& a, std::string& b) {
+            return a < b;
+        },
+        SmallThreshold(executor));
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(ToStd(v), expected);
+}
+
+TEST(ParallelSortTest, StableSortKeepsOrderOfEqualElements) {
+    ThreadExecutor executor(4);
+    std::mt19937 random(3);
+    std::vector<std::pair<int, int>> expected;
+    for (int i = 0; i < 500; ++i) {
+        expected.emplace_back(static_cast<int>(random() % 10), i);
+    }
+    Vector<std::pair<int, int>> v = ToVector(expected);
+    const auto by_key = [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.first < b.first;
+    };
+    ParallelStableSort(v, by_key, SmallThreshold(executor, 16));
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+    EXPECT_EQ(ToStd(v), expected);
+}
+
+TEST(ParallelSortTest, RadixSortMatchesStdSort) {
+    ThreadExecutor executor(4);
+    std::mt19937_64 random(4);
+    std::vector<long long> integers;
+    std::vector<double> doubles;
+    for (size_t i = 0; i < 5000; ++i) {
+        integers.push_back(static_cast<long long>(random()));
+        doubles.push_back(std::uniform_real_distribution<double>(-1e6, 1e6)(random));
+    }
+    Vector<long long> v = ToVector(integers);
+    Vector<double> d = ToVector(doubles);
+    ParallelSort(v, SmallThreshold(executor, 100));
+    ParallelStableSort(d, SmallThreshold(executor, 100));
+    std::sort(integers.begin(), integers.end());
+    std::sort(doubles.begin(), doubles.end());
+    EXPECT_EQ(ToStd(v), integers);
+    EXPECT_EQ(ToStd(d), doubles);
+}
+
+TEST(ParallelSortTest, UniqueAcrossChunkBorders) {
+    ThreadExecutor executor(4);
+    std::vector<int> values;
+    for (int i = 0; i < 100; ++i) {
+        values.insert(values.end(), i % 7 + 1, i);
+    }
+    const size_t size = values.size();
+    Vector<int> v = ToVector(values);
+    const size_t removed = Unique(v, SmallThreshold(executor, 3));
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    EXPECT_EQ(ToStd(v), values);
+    EXPECT_EQ(v.Size() + removed, size);
+}
+
+TEST(ParallelSortTest, MergeSortedInterleaved) {
+    ThreadExecutor executor(4);
+    for (size_t threshold : { 1, 4, 1000 }) {
+        std::vector<std::string> a = RandomStrings(37, 5);
+        std::vector<std::string> b = RandomStrings(23, 6);
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        Vector<std::string> dst = ToVector(a);
+        Vector<std::string> src = ToVector(b);
+        MergeSorted(
+            dst, std::move(src),
+            [](std::string x, std::string y) {
+                return x < y;
+            },
+            SmallThreshold(executor, threshold));
+        std::vector<std::string> expected;
+        std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+        EXPECT_EQ(ToStd(dst), expected);
+        EXPECT_EQ(src.Size(), 0u);
+    }
+}
@@ -0,0 +1,141 @@
+#include "stable_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+// Аллокатор с состоянием, который не переходит к другому контейнеру при перемещающем
+// присваивании. Помнит, каким экземпляром выделен каждый блок
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::false_type;
+    using is_always_equal = std::false_type;
+
+    explicit ArenaAllocator(int id_)
+        : id(id_) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept  // NOLINT(google-explicit-constructor)
+        : id(other.id) {
+    }
+
+    T* allocate(size_t n) {
+        ++Live()[id];
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        --Live()[id];
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    friend bool operator==(const ArenaAllocator& lhs, const ArenaAllocator& rhs) noexcept {
+        return lhs.id == rhs.id;
+    }
+
+    friend bool operator!=(const ArenaAllocator& lhs, const ArenaAllocator& rhs) noexcept {
+        return lhs.id != rhs.id;
+    }
+
+    static int* Live() {
+        static int live[2] = {};
+        return live;
+    }
+
+    int id;
+};
+
+}  // namespace
+
+// Каталог блоков растёт через memcpy: блок с std::allocator или тривиально копируемым
+// аллокатором перемещается побайтово
+static_assert(kIsTriviallyRelocatable<RawMemory<std::string>>);
+static_assert(kIsTriviallyRelocatable<RawMemory<int, ArenaAllocator<int>>>);
+
+TEST(StableVectorTest, ReferencesSurviveGrowth) {
+    StableVector<std::string, 4> v;
+    v.PushBack("first");
+    const std::string* first = &v[0];
+    std::vector<const std::string*> addresses;
+    for (int i = 0; i < 1000; ++i) {
+        addresses.push_back(&v.EmplaceBack(std::to_string(i)));
+    }
+    EXPECT_EQ(first, &v[0]);
+    EXPECT_EQ(*first, "first");
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(addresses[i], &v[i + 1]);
+        ASSERT_EQ(v[i + 1], std::to_string(i));
+    }
+}
+
+TEST(StableVectorTest, PopBackOnEmptyDoesNothing) {
+    StableVector<int, 4> v;
+    v.PopBack();
+    EXPECT_EQ(v.Size(), 0u);
+    v.PushBack(1);
+    v.PopBack();
+    v.PopBack();
+    EXPECT_EQ(v.Size(), 0u);
+}
+
+TEST(StableVectorTest, MoveAssignmentKeepsNonPropagatingAllocator) {
+    using Alloc = ArenaAllocator<std::string>;
+    {
+        StableVector<std::string, 4, Alloc> source{ Alloc(0) };
+        for (int i = 0; i < 10; ++i) {
+            source.PushBack(std::to_string(i));
+        }
+        StableVector<std::string, 4, Alloc> target{ Alloc(1) };
+        target.PushBack("old");
+
+        target = std::move(source);
+        EXPECT_EQ(target.GetAllocator().id, 1);
+        EXPECT_EQ(source.GetAllocator().id, 0);
+        ASSERT_EQ(target.Size(), 10u);
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_EQ(target[i], std::to_string(i));
+        }
+    }
+    EXPECT_EQ(Alloc::Live()[0], 0);
+    EXPECT_EQ(Alloc::Live()[1], 0);
+}
+
+TEST(StableVectorTest, MoveAssignmentWithEqualAllocatorsTakesChunks) {
+    using Alloc = ArenaAllocator<int>;
+    StableVector<int, 4, Alloc> source{ Alloc(0) };
+    for (int i = 0; i < 10; ++i) {
+        source.PushBack(i);
+    }
+    const int* first = &source[0];
+    StableVector<int, 4, Alloc> target{ Alloc(0) };
+    target = std::move(source);
+    EXPECT_EQ(&target[0], first);
+    EXPECT_EQ(target.Size(), 10u);
+}
+
+TEST(StableVectorTest, CopyAndShrink) {
+    StableVector<int, 8> v;
+    for (int i = 0; i < 100; ++i) {
+        v.PushBack(i);
+    }
+    StableVector<int, 8> copy = v;
+    for (int i = 0; i < 90; ++i) {
+        copy.PopBack();
+    }
+    copy.ShrinkToFit();
+    EXPECT_EQ(copy.Capacity(), 16u);
+    EXPECT_EQ(v.Size(), 100u);
+    int expected = 0;
+    for (int value : copy) {
+        EXPECT_EQ(value, expected++);
+    }
+    EXPECT_EQ(expected, 10);
+}
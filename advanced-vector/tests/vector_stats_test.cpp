@@ -0,0 +1,93 @@
+#include "vector.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+static_assert(kVectorStatsEnabled, "vector_stats_test must be built with ADVANCED_VECTOR_STATS");
+
+namespace {
+
+template <typename Tag>
+using TaggedVector = Vector<int, TaggedAllocator<int, Tag>>;
+
+template <typename Tag>
+VectorStatsSnapshot Snapshot() {
+    return GetVectorStats<Tag>().GetSnapshot();
+}
+
+}  // namespace
+
+TEST(VectorStatsTest, CountsAllocationsAndRelocations) {
+    struct Tag {};
+    {
+        TaggedVector<Tag> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(i);
+        }
+        // Вместимость 1, 2, 4, 8: четыре выделения, три из них с переносом
+        const VectorStatsSnapshot stats = Snapshot<Tag>();
+        EXPECT_EQ(stats.allocations, 4u);
+        EXPECT_EQ(stats.deallocations, 3u);
+        EXPECT_EQ(stats.reallocations, 3u);
+        EXPECT_EQ(stats.bytes_relocated, (1 + 2 + 4) * sizeof(int));
+        EXPECT_EQ(stats.live_capacity_bytes, 8 * sizeof(int));
+        // Во время переноса живы и старый, и новый буфер
+        EXPECT_EQ(stats.peak_capacity_bytes, (4 + 8) * sizeof(int));
+    }
+    const VectorStatsSnapshot stats = Snapshot<Tag>();
+    EXPECT_EQ(stats.deallocations, 4u);
+    EXPECT_EQ(stats.live_capacity_bytes, 0u);
+    // Перенос освобождает заполненные буферы, разрушение - буфер с тремя свободными местами
+    EXPECT_EQ(stats.wasted_capacity_bytes, 3 * sizeof(int));
+}
+
+TEST(VectorStatsTest, WasteIsRecordedWheneverBufferIsReleased) {
+    struct Tag {};
+    TaggedVector<Tag> v;
+    v.Reserve(10);
+    v.PushBack(1);
+    v.Reserve(20);
+    EXPECT_EQ(Snapshot<Tag>().wasted_capacity_bytes, 9 * sizeof(int));
+
+    v.ShrinkToFit();
+    EXPECT_EQ(Snapshot<Tag>().wasted_capacity_bytes, (9 + 19) * sizeof(int));
+
+    v.Reserve(4);
+    v.Clear(true);
+    EXPECT_EQ(Snapshot<Tag>().wasted_capacity_bytes, (9 + 19 + 4) * sizeof(int));
+    EXPECT_EQ(Snapshot<Tag>().live_capacity_bytes, 0u);
+
+    TaggedVector<Tag> big(100);
+    v.Reserve(8);
+    v = big;
+    EXPECT_EQ(Snapshot<Tag>().wasted_capacity_bytes, (9 + 19 + 4 + 8) * sizeof(int));
+}
+
+TEST(VectorStatsTest, ResetKeepsLiveCapacity) {
+    struct Tag {};
+    TaggedVector<Tag> v(16);
+    GetVectorStats<Tag>().Reset();
+    const VectorStatsSnapshot stats = Snapshot<Tag>();
+    EXPECT_EQ(stats.allocations, 0u);
+    EXPECT_EQ(stats.live_capacity_bytes, 16 * sizeof(int));
+    EXPECT_EQ(stats.peak_capacity_bytes, 16 * sizeof(int));
+}
+
+TEST(VectorStatsTest, ShrinkIntoInlineBufferReleasesHeapBuffer) {
+    struct Tag {};
+    {
+        SmallVector<int, 4, TaggedAllocator<int, Tag>> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        v.Resize(2);
+        const size_t capacity = v.Capacity();
+        const uint64_t wasted = Snapshot<Tag>().wasted_capacity_bytes;
+        v.ShrinkToFit();
+        EXPECT_EQ(v.Capacity(), 4u);
+        EXPECT_EQ(Snapshot<Tag>().wasted_capacity_bytes, wasted + (capacity - 2) * sizeof(int));
+    }
+    EXPECT_EQ(Snapshot<Tag>().live_capacity_bytes, 0u);
+}
@@ -1,289 +1,1223 @@
 #pragma once
+#include "constexpr_support.h"
+#include "growth_policy.h"
+#include "hardening.h"
+#include "parallel.h"
+#include "vector_stats.h"
+
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <new>
+#include <stdexcept>
 #include <utility>
 #include <memory>
+#include <type_traits>
+
+// Признак того, что объект типа T можно переместить в другую область памяти побайтовым
+// копированием, не вызывая ни конструктор перемещения, ни деструктор исходного объекта.
+// Для тривиально копируемых типов выводится автоматически, для остальных типов его можно
+// включить явной специализацией:
+//     template <> struct IsTriviallyRelocatable<MyType> : std::true_type {};
+template <typename T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+// std::unique_ptr со стандартным удалителем хранит лишь указатель и не зависит от своего адреса
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {};
 
 template <typename T>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+namespace detail {
+
+// Аллокатор умеет расширять блок памяти на месте:
+//     bool try_expand(T* ptr, size_t old_n, size_t new_n)
+template <typename Allocator, typename = void>
+struct HasTryExpand : std::false_type {};
+
+template <typename Allocator>
+struct HasTryExpand<Allocator, std::void_t<decltype(std::declval<Allocator&>().try_expand(
+    std::declval<typename Allocator::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+// Аллокатор умеет увеличивать блок с возможным побайтовым переносом, как realloc.
+// При неудаче возвращается nullptr, а прежний блок остаётся действительным:
+//     T* reallocate(T* ptr, size_t old_n, size_t new_n)
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(
+    std::declval<typename Allocator::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+// Аллокатор умеет сообщать реальную вместимость выделенного блока, как в C++23:
+//     auto allocate_at_least(size_t n) -> { T* ptr; size_t count; }
+template <typename Allocator, typename = void>
+struct HasAllocateAtLeast : std::false_type {};
+
+template <typename Allocator>
+struct HasAllocateAtLeast<Allocator, std::void_t<decltype(std::declval<Allocator&>().allocate_at_least(size_t{}).count)>>
+    : std::true_type {};
+
+}  // namespace detail
+
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Stats = detail::StatsHooks<Allocator>;
+
 public:
+    using allocator_type = Allocator;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    ADVANCED_VECTOR_CONSTEXPR explicit RawMemory(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Аллокатор, сообщающий реальный размер выделенного блока, может дать вместимость больше capacity
+    ADVANCED_VECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc) {
+        buffer_ = Allocate(capacity);
+        capacity_ = capacity;
+    }
+
+    // Принимает во владение буфер buffer вместимостью capacity, выделенный аллокатором, равным alloc.
+    // Для статистики такой буфер считается выделенным в момент передачи
+    RawMemory(T* buffer, size_t capacity, const Allocator& alloc) noexcept
+        : alloc_(alloc)
+        , buffer_(buffer)
         , capacity_(capacity) {
+        if (buffer_ != nullptr) {
+            Stats::OnAllocate(capacity_ * sizeof(T));
+        }
     }
 
-    ~RawMemory() {
+    RawMemory(const RawMemory&) = delete;
+    RawMemory& operator=(const RawMemory& rhs) = delete;
+
+    ADVANCED_VECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& rhs) noexcept {
+        if (this != &rhs) {
+            RawMemory temp(std::move(rhs));
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR ~RawMemory() {
         Deallocate(buffer_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    ADVANCED_VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    ADVANCED_VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    ADVANCED_VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    ADVANCED_VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    // Обменивается с other буферами и аллокаторами. Вызывающая сторона отвечает за то,
+    // чтобы обмен аллокаторами был допустим
+    ADVANCED_VECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
+        using std::swap;
+        swap(alloc_, other.alloc_);
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
-    const T* GetAddress() const noexcept {
+    ADVANCED_VECTOR_CONSTEXPR const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    ADVANCED_VECTOR_CONSTEXPR T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    // Отдаёт буфер вызывающей стороне, которая должна освободить его аллокатором, равным
+    // GetAllocator(), указав прежнюю вместимость. Сама RawMemory остаётся пустой
+    T* Release() noexcept {
+        if (buffer_ != nullptr) {
+            Stats::OnDeallocate(capacity_ * sizeof(T));
+            UnpoisonBuffer(buffer_);
+        }
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR size_t Capacity() const {
         return capacity_;
     }
 
+    ADVANCED_VECTOR_CONSTEXPR const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    static constexpr bool kCanExpand = detail::HasTryExpand<Allocator>::value;
+    static constexpr bool kCanReallocate = detail::HasReallocate<Allocator>::value;
+
+    // Пытается увеличить вместимость до new_capacity, не перемещая буфер.
+    // Содержимое памяти и адрес буфера при этом не меняются
+    bool TryExpand(size_t new_capacity) noexcept {
+        if constexpr (kCanExpand) {
+            if (buffer_ != nullptr && alloc_.try_expand(buffer_, capacity_, new_capacity)) {
+                Stats::OnGrowInPlace(capacity_ * sizeof(T), new_capacity * sizeof(T));
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Пытается изменить вместимость до new_capacity средствами аллокатора, который может
+    // перенести содержимое буфера побайтово. Допустимо только для тривиально перемещаемых T
+    bool TryReallocate(size_t new_capacity) noexcept {
+        static_assert(kIsTriviallyRelocatable<T>, "Buffer of T can't be relocated bytewise");
+        if constexpr (kCanReallocate) {
+            if (buffer_ != nullptr) {
+                UnpoisonBuffer(buffer_);
+                if (T* buffer = alloc_.reallocate(buffer_, capacity_, new_capacity)) {
+                    if (new_capacity < capacity_) {
+                        Stats::OnShrinkInPlace(capacity_ * sizeof(T), new_capacity * sizeof(T));
+                    } else {
+                        Stats::OnGrowInPlace(capacity_ * sizeof(T), new_capacity * sizeof(T));
+                    }
+                    buffer_ = buffer;
+                    capacity_ = new_capacity;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
 private:
-    // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    // Выделяет сырую память не меньше чем под n элементов и возвращает указатель на неё.
+    // Если аллокатор выделил больше, n увеличивается до полученной вместимости
+    ADVANCED_VECTOR_CONSTEXPR T* Allocate(size_t& n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        T* buf = nullptr;
+        if constexpr (detail::HasAllocateAtLeast<Allocator>::value) {
+            const auto result = alloc_.allocate_at_least(n);
+            buf = result.ptr;
+            n = result.count;
+        }
+        else {
+            buf = AllocTraits::allocate(alloc_, n);
+        }
+        Stats::OnAllocate(n * sizeof(T));
+        return buf;
     }
 
     // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    ADVANCED_VECTOR_CONSTEXPR void Deallocate(T* buf) noexcept {
+        if (buf != nullptr) {
+            Stats::OnDeallocate(capacity_ * sizeof(T));
+            UnpoisonBuffer(buf);
+            AllocTraits::deallocate(alloc_, buf, capacity_);
+        }
     }
 
+    // Снимает разметку AddressSanitizer, которую мог оставить вектор: аллокатор может
+    // переиспользовать память буфера, не зная о ней
+    ADVANCED_VECTOR_CONSTEXPR void UnpoisonBuffer(T* buf) const noexcept {
+        if (!detail::IsConstantEvaluated()) {
+            detail::AnnotateContiguousContainer(buf, buf + capacity_, buf, buf + capacity_);
+        }
+    }
+
+    [[no_unique_address]] Allocator alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
+// RawMemory хранит лишь аллокатор, указатель и вместимость, поэтому перемещается побайтово,
+// если так может перемещаться аллокатор. Пустой аллокатор, все копии которого равны, как
+// std::allocator, не имеет состояния, и его побайтовое перемещение ничего не теряет, даже если
+// конструктор копирования формально нетривиален
+template <typename T, typename Allocator>
+struct IsTriviallyRelocatable<RawMemory<T, Allocator>>
+    : std::bool_constant<kIsTriviallyRelocatable<Allocator>
+                         || (std::is_empty_v<Allocator> && std::allocator_traits<Allocator>::is_always_equal::value)> {};
+
+// Сырая память с встроенным буфером на N элементов. Пока требуемая вместимость не превышает N,
+// элементы хранятся внутри самого объекта, и память из кучи не выделяется.
+// Swap обменивает только буферы в куче: встроенные буферы обеих сторон в момент обмена
+// не должны содержать живых объектов
+template <typename T, size_t N, typename Allocator = std::allocator<T>>
+class InlineMemory {
+    static_assert(N > 0, "InlineMemory requires non-empty inline buffer");
+
+public:
+    using allocator_type = Allocator;
+
+    static constexpr size_t kInlineCapacity = N;
+
+    InlineMemory() = default;
+
+    explicit InlineMemory(const Allocator& alloc) noexcept
+        : heap_(alloc) {
+    }
+
+    explicit InlineMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : heap_(capacity > N ? capacity : 0, alloc) {
+    }
+
+    InlineMemory(const InlineMemory&) = delete;
+    InlineMemory& operator=(const InlineMemory& rhs) = delete;
+
+    T* operator+(size_t offset) noexcept {
+        assert(offset <= Capacity());
+        return GetAddress() + offset;
+    }
+
+    const T* operator+(size_t offset) const noexcept {
+        return const_cast<InlineMemory&>(*this) + offset;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<InlineMemory&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Capacity());
+        return GetAddress()[index];
+    }
+
+    void Swap(InlineMemory& other) noexcept {
+        heap_.Swap(other.heap_);
+    }
+
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    const T* GetAddress() const noexcept {
+        return const_cast<InlineMemory&>(*this).GetAddress();
+    }
+
+    T* GetAddress() noexcept {
+        return IsInline() ? reinterpret_cast<T*>(inline_buffer_) : heap_.GetAddress();
+    }
+
+    size_t Capacity() const {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    static constexpr bool kCanExpand = RawMemory<T, Allocator>::kCanExpand;
+    static constexpr bool kCanReallocate = RawMemory<T, Allocator>::kCanReallocate;
+
+    bool TryExpand(size_t new_capacity) noexcept {
+        return !IsInline() && heap_.TryExpand(new_capacity);
+    }
+
+    bool TryReallocate(size_t new_capacity) noexcept {
+        return !IsInline() && heap_.TryReallocate(new_capacity);
+    }
+
+private:
+    RawMemory<T, Allocator> heap_;
+    alignas(T) unsigned char inline_buffer_[N * sizeof(T)];
+};
+
+// Сырая память фиксированной вместимости N без обращений к куче. Запрос большей вместимости,
+// например рост заполненного вектора, выбрасывает std::length_error. Аллокатор лишь
+// удовлетворяет интерфейсу хранилища и память не выделяет.
+//
+// При вычислении на этапе компиляции байтовый буфер недоступен, и память под N элементов
+// на время вычисления выделяет std::allocator: как и Vector, StaticVector, созданный
+// при компиляции, должен там же и разрушиться
+template <typename T, size_t N>
+class FixedMemory {
+    static_assert(N > 0, "FixedMemory requires non-empty buffer");
+
+public:
+    using allocator_type = std::allocator<T>;
+
+    static constexpr size_t kInlineCapacity = N;
+
+    ADVANCED_VECTOR_CONSTEXPR FixedMemory() noexcept {
+        if (detail::IsConstantEvaluated()) {
+            constant_buffer_ = allocator_type().allocate(N);
+        }
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR explicit FixedMemory(const allocator_type& /*alloc*/) noexcept
+        : FixedMemory() {
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR explicit FixedMemory(size_t capacity, const allocator_type& /*alloc*/ = allocator_type())
+        : FixedMemory() {
+        if (capacity > N) {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+
+    FixedMemory(const FixedMemory&) = delete;
+    FixedMemory& operator=(const FixedMemory& rhs) = delete;
+
+    ADVANCED_VECTOR_CONSTEXPR ~FixedMemory() {
+        if (detail::IsConstantEvaluated()) {
+            allocator_type().deallocate(constant_buffer_, N);
+        }
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
+        assert(offset <= N);
+        return GetAddress() + offset;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
+        return const_cast<FixedMemory&>(*this) + offset;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
+        return const_cast<FixedMemory&>(*this)[index];
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        assert(index < N);
+        return GetAddress()[index];
+    }
+
+    // Обменивать нечего: элементы встроенного буфера вектор переносит сам
+    ADVANCED_VECTOR_CONSTEXPR void Swap(FixedMemory& /*other*/) noexcept {
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR bool IsInline() const noexcept {
+        return true;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR const T* GetAddress() const noexcept {
+        return const_cast<FixedMemory&>(*this).GetAddress();
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR T* GetAddress() noexcept {
+        if (detail::IsConstantEvaluated()) {
+            return constant_buffer_;
+        }
+        return reinterpret_cast<T*>(buffer_);
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR size_t Capacity() const {
+        return N;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR const allocator_type& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    static constexpr bool kCanExpand = false;
+    static constexpr bool kCanReallocate = false;
+
+    ADVANCED_VECTOR_CONSTEXPR bool TryExpand(size_t /*new_capacity*/) noexcept {
+        return false;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR bool TryReallocate(size_t /*new_capacity*/) noexcept {
+        return false;
+    }
+
+private:
+    [[no_unique_address]] allocator_type alloc_;
+    // Активен buffer_, а при вычислении на этапе компиляции - constant_buffer_
+    union {
+        alignas(T) unsigned char buffer_[N * sizeof(T)];
+        T* constant_buffer_;
+    };
+};
+
+namespace detail {
+
+// Хранилище может держать элементы во встроенном буфере, который нельзя передать при обмене
+template <typename Storage, typename = void>
+struct HasInlineBuffer : std::false_type {};
+
+template <typename Storage>
+struct HasInlineBuffer<Storage, std::void_t<decltype(std::declval<const Storage&>().IsInline())>> : std::true_type {};
+
+// Просит процессор заранее загрузить в кэш строку по адресу address. Программная
+// предвыборка не обращается к памяти по-настоящему, поэтому адрес может быть и нулевым
+inline void Prefetch(const void* address) noexcept {
+#if defined(__GNUC__)
+    __builtin_prefetch(address, 0, 3);
+#else
+    static_cast<void>(address);
+#endif
+}
+
+template <typename T, typename = void>
+struct HasGet : std::false_type {};
+
+template <typename T>
+struct HasGet<T, std::void_t<decltype(std::declval<const T&>().get())>> : std::true_type {};
+
+// Адрес объекта, на который указывает обычный или умный указатель item
 template <typename T>
-class Vector {
+const void* PointeeAddress(const T& item) noexcept {
+    if constexpr (std::is_pointer_v<T>) {
+        static_assert(std::is_object_v<std::remove_pointer_t<T>>, "Only object pointers can be prefetched");
+        return static_cast<const void*>(item);
+    }
+    else {
+        static_assert(HasGet<T>::value, "ForEachPrefetched requires pointer elements or smart pointers with get()");
+        return static_cast<const void*>(item.get());
+    }
+}
+
+}  // namespace detail
+
+// Тег конструктора и метода ResizeDefaultInit, создающих элементы инициализацией по умолчанию.
+// Для тривиальных типов (int, char, POD-структуры) память при этом не заполняется нулями
+struct DefaultInitTag {
+    explicit DefaultInitTag() = default;
+};
+
+inline constexpr DefaultInitTag default_init{};
+
+// Буфер, отданный вектором вместе с элементами, см. BasicVector::Release
+template <typename T>
+struct VectorBuffer {
+    T* ptr;
+    size_t size;
+    size_t capacity;
+};
+
+// Общая реализация динамического массива поверх хранилища сырой памяти Storage (RawMemory, InlineMemory или FixedMemory).
+// Аллокатор хранилища используется только для выделения и освобождения сырой памяти,
+// элементы по-прежнему создаются и разрушаются самим вектором.
+// GrowthPolicy выбирает новую вместимость при росте вектора (см. growth_policy.h)
+template <typename T, typename Storage, typename GrowthPolicy = DoublingGrowth>
+class BasicVector {
+    using Allocator = typename Storage::allocator_type;
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Stats = detail::StatsHooks<Allocator>;
+
 public:
+    using allocator_type = Allocator;
+
+    BasicVector() = default;
+
+    ADVANCED_VECTOR_CONSTEXPR explicit BasicVector(const Allocator& alloc) noexcept
+        : data_(alloc)
+    {
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR explicit BasicVector(size_t size, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+        , size_(size)
+    {
+        detail::UninitializedValueConstructN(data_.GetAddress(), size);
+        Annotate(Capacity(), size_);
+    }
 
-    Vector() = default;
+    // Создаёт size элементов, инициализированных значением, частями на исполнителе policy
+    BasicVector(size_t size, const ParallelPolicy& policy, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+    {
+        detail::ParallelConstruct(policy, data_.GetAddress(), size, [](T* first, size_t, size_t count) {
+            std::uninitialized_value_construct_n(first, count);
+        });
+        size_ = size;
+        Annotate(Capacity(), size_);
+    }
 
-    explicit Vector(size_t size)
-        : data_(size)
+    ADVANCED_VECTOR_CONSTEXPR BasicVector(size_t size, DefaultInitTag, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
         , size_(size)
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        detail::UninitializedDefaultConstructN(data_.GetAddress(), size);
+        Annotate(Capacity(), size_);
     }
 
-    Vector(const Vector& other)
-        : data_(other.size_)
+    ADVANCED_VECTOR_CONSTEXPR BasicVector(const BasicVector& other)
+        : BasicVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR BasicVector(const BasicVector& other, const Allocator& alloc)
+        : data_(other.size_, alloc)
         , size_(other.size_)
     {
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+        UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+        Annotate(Capacity(), size_);
+    }
+
+    // Копирует элементы other частями на исполнителе policy
+    BasicVector(const BasicVector& other, const ParallelPolicy& policy)
+        : data_(other.size_, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+        const T* source = other.data_.GetAddress();
+        detail::ParallelConstruct(policy, data_.GetAddress(), other.size_, [source](T* first, size_t offset, size_t count) {
+            UninitializedCopyN(source + offset, count, first);
+        });
+        size_ = other.size_;
+        Annotate(Capacity(), size_);
     }
-    Vector(Vector&& other) noexcept {
-        Swap(other);
+
+    // Буфер other переходит к новому вектору вместе с разметкой для AddressSanitizer
+    ADVANCED_VECTOR_CONSTEXPR BasicVector(BasicVector&& other) noexcept(!kHasInlineBuffer || std::is_nothrow_move_constructible_v<T>)
+        : data_(other.data_.GetAllocator())
+    {
+        MoveFrom(other);
     }
 
+    // Итератор защищённого режима: указатель на элемент, вектор-владелец и поколение его
+    // буфера на момент создания итератора. Разыменование проверяет, что буфер с тех пор
+    // не сменился и элемент лежит в пределах [begin(), end())
+    template <typename Item>
+    class CheckedIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Item*;
+        using reference = Item&;
 
-    using iterator = T*;
-    using const_iterator = const T*;
+        CheckedIterator() = default;
 
-    iterator begin() noexcept {
-        return data_.GetAddress();
+        // Неконстантный итератор преобразуется в константный
+        template <typename Other, typename = std::enable_if_t<std::is_same_v<Other, T> && std::is_same_v<Item, const T>>>
+        ADVANCED_VECTOR_CONSTEXPR CheckedIterator(const CheckedIterator<Other>& other) noexcept  // NOLINT(google-explicit-constructor)
+            : owner_(other.owner_)
+            , ptr_(other.ptr_)
+            , generation_(other.generation_) {
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR reference operator*() const noexcept {
+            CheckDereferenceable();
+            return *ptr_;
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR pointer operator->() const noexcept {
+            CheckDereferenceable();
+            return ptr_;
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR reference operator[](difference_type offset) const noexcept {
+            return *(*this + offset);
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR CheckedIterator& operator++() noexcept {
+            ++ptr_;
+            return *this;
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR CheckedIterator operator++(int) noexcept {
+            CheckedIterator copy = *this;
+            ++ptr_;
+            return copy;
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR CheckedIterator& operator--() noexcept {
+            --ptr_;
+            return *this;
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR CheckedIterator operator--(int) noexcept {
+            CheckedIterator copy = *this;
+            --ptr_;
+            return copy;
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR CheckedIterator& operator+=(difference_type offset) noexcept {
+            ptr_ += offset;
+            return *this;
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR CheckedIterator& operator-=(difference_type offset) noexcept {
+            ptr_ -= offset;
+            return *this;
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR CheckedIterator operator+(CheckedIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR CheckedIterator operator+(difference_type offset, CheckedIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR CheckedIterator operator-(CheckedIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            CheckComparable(lhs, rhs);
+            return lhs.ptr_ - rhs.ptr_;
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            CheckComparable(lhs, rhs);
+            return lhs.ptr_ == rhs.ptr_;
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR bool operator!=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR bool operator<(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            CheckComparable(lhs, rhs);
+            return lhs.ptr_ < rhs.ptr_;
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR bool operator>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR bool operator<=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend ADVANCED_VECTOR_CONSTEXPR bool operator>=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class BasicVector;
+        template <typename>
+        friend class CheckedIterator;
+
+        ADVANCED_VECTOR_CONSTEXPR CheckedIterator(const BasicVector* owner, Item* ptr) noexcept
+            : owner_(owner)
+            , ptr_(ptr)
+            , generation_(owner->hardened_.generation) {
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR bool IsValid() const noexcept {
+            return owner_ != nullptr && generation_ == owner_->hardened_.generation;
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR void CheckDereferenceable() const noexcept {
+            ADVANCED_VECTOR_CHECK(IsValid(), "iterator used after the vector buffer was replaced");
+            const T* first = owner_->data_.GetAddress();
+            ADVANCED_VECTOR_CHECK(first <= ptr_ && ptr_ < first + owner_->size_, "iterator out of range");
+        }
+
+        static ADVANCED_VECTOR_CONSTEXPR void CheckComparable(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            ADVANCED_VECTOR_CHECK(lhs.owner_ == rhs.owner_, "iterators of different vectors compared");
+        }
+
+        const BasicVector* owner_ = nullptr;
+        Item* ptr_ = nullptr;
+        size_t generation_ = 0;
+    };
+
+    using iterator = std::conditional_t<kVectorHardened, CheckedIterator<T>, T*>;
+    using const_iterator = std::conditional_t<kVectorHardened, CheckedIterator<const T>, const T*>;
+
+    ADVANCED_VECTOR_CONSTEXPR iterator begin() noexcept {
+        return MakeIterator(0);
     }
-    iterator end() noexcept {
-        return data_.GetAddress() + size_;
+    ADVANCED_VECTOR_CONSTEXPR iterator end() noexcept {
+        return MakeIterator(size_);
     }
-    const_iterator begin() const noexcept {
-        return const_iterator(data_.GetAddress());
+    ADVANCED_VECTOR_CONSTEXPR const_iterator begin() const noexcept {
+        return MakeIterator(0);
     }
-    const_iterator end() const noexcept {
-        return const_iterator(data_.GetAddress() + size_);
+    ADVANCED_VECTOR_CONSTEXPR const_iterator end() const noexcept {
+        return MakeIterator(size_);
     }
-    const_iterator cbegin() const noexcept {
+    ADVANCED_VECTOR_CONSTEXPR const_iterator cbegin() const noexcept {
         return begin();
     }
-    const_iterator cend() const noexcept {
-        return end();
+    ADVANCED_VECTOR_CONSTEXPR const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Указатель на первый элемент. В отличие от итераторов, в защищённом режиме не проверяется
+    ADVANCED_VECTOR_CONSTEXPR T* Data() noexcept {
+        return data_.GetAddress();
+    }
+    ADVANCED_VECTOR_CONSTEXPR const T* Data() const noexcept {
+        return data_.GetAddress();
+    }
+
+    template <typename... N>
+    ADVANCED_VECTOR_CONSTEXPR iterator Emplace(const_iterator pos, N&&... arg) {
+        const size_t i = IndexOf(pos);
+        ADVANCED_VECTOR_CHECK(i <= size_, "Emplace position out of range");
+        if (i == size_) {
+            EmplaceBack(std::forward<N>(arg)...);
+            return MakeIterator(i);
+        }
+        const MutationScope scope(*this, size_ + 1);
+        if (size_ == Capacity() && !GrowInPlace(NextCapacity(size_ + 1), arg...)) {
+            Storage temp_vec(NextCapacity(size_ + 1), data_.GetAllocator());
+            detail::ConstructAt(temp_vec + i, std::forward<N>(arg)...);
+            RelocateAroundGap(temp_vec, i, 1);
+            RecordRelocation();
+            data_.Swap(temp_vec);
+
+            ++size_;
+            return MakeIterator(i);
+        }
+        else {
+            if constexpr (kIsTriviallyRelocatable<T>) {
+                // Хвост сдвигается одним memmove, и элемент создаётся прямо в освободившемся месте.
+                // Аргумент, ссылающийся на элемент вектора, сдвинулся бы вместе с хвостом,
+                // поэтому в этом случае элемент сначала создаётся во временном объекте
+                if (ArgumentsAlias(arg...)) {
+                    T temp(std::forward<N>(arg)...);
+                    EmplaceInGap(i, std::move(temp));
+                }
+                else {
+                    EmplaceInGap(i, std::forward<N>(arg)...);
+                }
+            }
+            else if constexpr (sizeof...(N) == 1 && (std::is_same_v<std::decay_t<N>, T> && ...)) {
+                // Готовое значение присваивается на место без промежуточного объекта,
+                // если оно не лежит в сдвигаемой части вектора
+                if (ArgumentsAlias(arg...)) {
+                    T temp(std::forward<N>(arg)...);
+                    ShiftTailRight(i);
+                    data_[i] = std::move(temp);
+                }
+                else {
+                    ShiftTailRight(i);
+                    data_[i] = (std::forward<N>(arg), ...);
+                }
+            }
+            else {
+                T temp(std::forward<N>(arg)...);
+                ShiftTailRight(i);
+                data_[i] = std::move(temp);
+            }
+
+            ++size_;
+            return MakeIterator(i);
+        }
+    }
+
+
+    ADVANCED_VECTOR_CONSTEXPR iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        ADVANCED_VECTOR_CHECK(IndexOf(pos) < size_, "Erase position out of range");
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет элементы диапазона [first, last), сдвигая хвост за один проход.
+    // Хвост тривиально перемещаемых элементов переносится одним memmove
+    ADVANCED_VECTOR_CONSTEXPR iterator Erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        const size_t i = IndexOf(first);
+        const size_t end_index = IndexOf(last);
+        ADVANCED_VECTOR_CHECK(i <= end_index && end_index <= size_, "Erase range out of range");
+        const size_t count = end_index - i;
+        if (count == 0) {
+            return MakeIterator(i);
+        }
+        const MutationScope scope(*this);
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            const size_t elems_after = size_ - i - count;
+            std::destroy_n(data_ + i, count);
+            ShiftBytes(data_ + (i + count), elems_after, -static_cast<std::ptrdiff_t>(count));
+        }
+        else {
+            std::move(data_ + (i + count), data_ + size_, data_ + i);
+            std::destroy_n(data_ + (size_ - count), count);
+        }
+        size_ -= count;
+        return MakeIterator(i);
+    }
+
+    // Удаляет все элементы, для которых pred возвращает true, за один проход,
+    // сохраняя порядок остальных. Возвращает количество удалённых элементов
+    template <typename Predicate>
+    ADVANCED_VECTOR_CONSTEXPR size_t EraseIf(Predicate pred) {
+        const MutationScope scope(*this);
+        T* const new_end = std::remove_if(data_.GetAddress(), data_ + size_, pred);
+        const size_t removed = static_cast<size_t>(data_ + size_ - new_end);
+        std::destroy_n(new_end, removed);
+        size_ -= removed;
+        return removed;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
     }
 
+    ADVANCED_VECTOR_CONSTEXPR iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
 
+    // Вставляет count копий value перед pos. Хвост вектора сдвигается один раз,
+    // а память при необходимости выделяется не более одного раза
+    ADVANCED_VECTOR_CONSTEXPR iterator Insert(const_iterator pos, size_t count, const T& value) {
+        return InsertN(pos, count, FillSource{ value });
+    }
 
-    template <typename... N>
-    iterator Emplace(const_iterator pos, N&&... arg) {
-        assert(pos >= begin() && pos <= end());
-        if (pos == end()) {
-            return &EmplaceBack(std::forward<N>(arg)...);
-        }
-        if (size_ == Capacity()) {
-            size_t i = static_cast<size_t>(pos - begin());
-            RawMemory<T> temp_vec{ size_ == 0 ? 1 : size_ * 2 };
-            new (temp_vec + i) T(std::forward<N>(arg)...);
-            try {
-                MoveOrCopy(data_.GetAddress(), i, temp_vec.GetAddress());
-            }
-            catch (...) {
-                temp_vec[i].~T();
-                throw;
+    // Вставляет перед pos копии элементов диапазона [first, last), который не должен
+    // ссылаться на элементы самого вектора. Для однопроходных итераторов элементы
+    // добавляются в конец и затем переставляются на место
+    template <typename InputIt, typename = std::enable_if_t<std::is_base_of_v<
+        std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>>>
+    ADVANCED_VECTOR_CONSTEXPR iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+            const auto count = static_cast<size_t>(std::distance(first, last));
+            return InsertN(pos, count, RangeSource<InputIt>{ first });
+        }
+        else {
+            const size_t i = IndexOf(pos);
+            ADVANCED_VECTOR_CHECK(i <= size_, "Insert position out of range");
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
             }
+            std::rotate(data_ + i, data_ + old_size, data_ + size_);
+            return MakeIterator(i);
+        }
+    }
 
-            try {
-                MoveOrCopy(data_ + i, size_ - i, temp_vec + (i + 1));
-            }
-            catch (...) {
-                std::destroy_n(temp_vec.GetAddress(), i + 1);
-                throw;
-            }
-            data_.Swap(temp_vec);
+    // Добавляет в конец вектора копии элементов диапазона [first, last)
+    template <typename InputIt, typename = std::enable_if_t<std::is_base_of_v<
+        std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>>>
+    ADVANCED_VECTOR_CONSTEXPR void Append(InputIt first, InputIt last) {
+        Insert(end(), first, last);
+    }
 
-            ++size_;
-            return begin() + i;
+    // Элементы разрушаются частями, если программа задала политику SetDestructorPolicy
+    ADVANCED_VECTOR_CONSTEXPR ~BasicVector() {
+        const ParallelPolicy* policy = detail::IsConstantEvaluated() ? nullptr : GetDestructorPolicy();
+        if (policy != nullptr) {
+            detail::ParallelDestroy(*policy, data_.GetAddress(), size_);
         }
         else {
-            size_t i = static_cast<size_t>(pos - begin());
-            T temp(std::forward<N>(arg)...);
-            new (end()) T(std::move(data_[size_ - 1]));
-            std::move_backward(begin() + i, end() - 1, end());
-            data_[i] = std::move(temp);
+            std::destroy_n(data_.GetAddress(), size_);
+        }
+        RecordRelease();
+    }
 
-            ++size_;
-            return begin() + i;
+    // Уменьшает вместимость до размера вектора. SmallVector, элементы которого
+    // помещаются во встроенный буфер, возвращается к нему и освобождает память в куче
+    ADVANCED_VECTOR_CONSTEXPR void ShrinkToFit() {
+        const MutationScope scope(*this);
+        if (Capacity() == size_) {
+            return;
+        }
+        if (size_ == 0 && !IsUsingInlineBuffer()) {
+            ReleaseMemory();
+            return;
+        }
+        if constexpr (kHasInlineBuffer) {
+            if (!data_.IsInline() && size_ <= Storage::kInlineCapacity) {
+                Storage heap(data_.GetAllocator());
+                heap.Swap(data_);
+                try {
+                    MoveOrCopy(heap.GetAddress(), size_, data_.GetAddress());
+                }
+                catch (...) {
+                    data_.Swap(heap);
+                    throw;
+                }
+                Stats::OnRelease((heap.Capacity() - size_) * sizeof(T));
+                return;
+            }
+            if (data_.IsInline()) {
+                return;
+            }
+        }
+        if constexpr (kIsTriviallyRelocatable<T> && Storage::kCanReallocate) {
+            if (data_.TryReallocate(size_)) {
+                return;
+            }
+        }
+        Storage temp_data(size_, data_.GetAllocator());
+        if (temp_data.Capacity() >= Capacity()) {
+            // Аллокатор не может выделить блок меньше текущего
+            return;
         }
+        MoveOrCopy(data_.GetAddress(), size_, temp_data.GetAddress());
+        RecordRelocation();
+        data_.Swap(temp_data);
     }
 
+    // Clear, разрушающий элементы частями на исполнителе policy. Деструктор вектора работает
+    // в одном потоке, если не задана SetDestructorPolicy, поэтому большой вектор стоит очистить
+    // так перед разрушением
+    void Clear(const ParallelPolicy& policy, bool release_memory = false) noexcept {
+        const MutationScope scope(*this);
+        detail::ParallelDestroy(policy, data_.GetAddress(), size_);
+        size_ = 0;
+        if (release_memory) {
+            ReleaseMemory();
+        }
+    }
 
-    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
-        assert(pos >= begin() && pos < end());
-        size_t space = pos - begin();
-        std::move(begin() + space + 1, end(), begin() + space);
-        PopBack();
-        return begin() + space;
+    // Удаляет все элементы. При release_memory == true вектор также освобождает свою память
+    ADVANCED_VECTOR_CONSTEXPR void Clear(bool release_memory = false) noexcept {
+        const MutationScope scope(*this);
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+        if (release_memory) {
+            ReleaseMemory();
+        }
     }
 
-    iterator Insert(const_iterator pos, const T& value) {
-        return Emplace(pos, value);
+    // Заменяет содержимое вектора буфером ptr вместимостью capacity, в начале которого уже
+    // созданы size элементов. Буфер должен быть выделен аллокатором, равным alloc, и теперь
+    // освобождается вектором. Если аллокатор не передаётся при перемещающем присваивании,
+    // alloc должен быть равен текущему аллокатору вектора
+    void Adopt(T* ptr, size_t size, size_t capacity, const Allocator& alloc) noexcept {
+        static_assert(!kHasInlineBuffer, "Vector with inline buffer can't adopt external memory");
+        assert(size <= capacity && (ptr != nullptr || capacity == 0));
+        assert(AllocTraits::propagate_on_container_move_assignment::value || alloc == GetAllocator());
+        const MutationScope scope(*this);
+        Storage adopted(ptr, capacity, alloc);
+        RecordRelease();
+        std::destroy_n(data_.GetAddress(), size_);
+        data_.Swap(adopted);
+        size_ = size;
     }
 
-    iterator Insert(const_iterator pos, T&& value) {
-        return Emplace(pos, std::move(value));
+    // Передаёт вызывающей стороне буфер вместе с элементами. Разрушить элементы и освободить
+    // память аллокатором, равным GetAllocator(), должна она. Вектор остаётся пустым и без памяти
+    VectorBuffer<T> Release() noexcept {
+        static_assert(!kHasInlineBuffer, "Vector with inline buffer can't release its memory");
+        const MutationScope scope(*this);
+        VectorBuffer<T> buffer{ nullptr, size_, Capacity() };
+        buffer.ptr = data_.Release();
+        size_ = 0;
+        return buffer;
     }
 
-    ~Vector() {
-        std::destroy_n(data_.GetAddress(), size_);
+    // Resize, создающий или разрушающий элементы частями на исполнителе policy.
+    // Если создание какой-либо части выбросило исключение, размер вектора не меняется
+    void Resize(size_t new_size, const ParallelPolicy& policy) {
+        const MutationScope scope(*this, new_size);
+        if (size_ > new_size) {
+            detail::ParallelDestroy(policy, data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+        }
+        else if (size_ < new_size) {
+            Reserve(new_size);
+            detail::ParallelConstruct(policy, data_.GetAddress() + size_, new_size - size_, [](T* first, size_t, size_t count) {
+                std::uninitialized_value_construct_n(first, count);
+            });
+            size_ = new_size;
+        }
     }
 
-    void Resize(size_t new_size) {
+    ADVANCED_VECTOR_CONSTEXPR void Resize(size_t new_size) {
         if (size_ == new_size) {
             return;
         }
+        const MutationScope scope(*this, new_size);
         if (size_ > new_size) {
             std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
             size_ = new_size;
         }
         else {
             Reserve(new_size);
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            detail::UninitializedValueConstructN(data_.GetAddress() + size_, new_size - size_);
             size_ = new_size;
         }
 
     }
 
+    // Как Resize, но новые элементы инициализируются по умолчанию: значения тривиальных
+    // элементов остаются неопределёнными, пока их не перезапишут
+    ADVANCED_VECTOR_CONSTEXPR void ResizeDefaultInit(size_t new_size) {
+        const MutationScope scope(*this, new_size);
+        if (size_ >= new_size) {
+            Resize(new_size);
+            return;
+        }
+        Reserve(new_size);
+        detail::UninitializedDefaultConstructN(data_.GetAddress() + size_, new_size - size_);
+        size_ = new_size;
+    }
+
+    // Как resize_and_overwrite у std::string: выделяет память под new_size элементов и вызывает
+    // op(Data(), new_size), которая записывает байты элементов [Size(), new_size) и возвращает
+    // итоговый размер не больше new_size. Элементы не создаются конструктором, поэтому T должен
+    // быть тривиально копируемым. Если op выбросит исключение, размер вектора не меняется
+    template <typename Operation>
+    void ResizeAndOverwrite(size_t new_size, Operation op) {
+        static_assert(std::is_trivially_copyable_v<T>, "Elements must be trivially copyable to be overwritten bytewise");
+        const MutationScope scope(*this, new_size);
+        Reserve(new_size);
+        const size_t size = op(data_.GetAddress(), new_size);
+        assert(size <= new_size);
+        size_ = size;
+    }
+
     template <typename... N>
-    T& EmplaceBack(N&&... arg) {
+    ADVANCED_VECTOR_CONSTEXPR T& EmplaceBack(N&&... arg) {
+        const MutationScope scope(*this, size_ + 1);
         T* t = nullptr;
-        if (size_ == Capacity()) {
-            RawMemory<T> temp_data(size_ == 0 ? 1 : size_ * 2);
-            t = new (temp_data + size_) T(std::forward<N>(arg)...);
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(data_.GetAddress(), size_, temp_data.GetAddress());
+        if (size_ == Capacity() && !GrowInPlace(NextCapacity(size_ + 1), arg...)) {
+            Storage temp_data(NextCapacity(size_ + 1), data_.GetAllocator());
+            t = detail::ConstructAt(temp_data + size_, std::forward<N>(arg)...);
+            try {
+                MoveOrCopy(data_.GetAddress(), size_, temp_data.GetAddress());
             }
-            else {
-                std::uninitialized_copy_n(data_.GetAddress(), size_, temp_data.GetAddress());
+            catch (...) {
+                std::destroy_at(t);
+                throw;
             }
-            std::destroy_n(data_.GetAddress(), size_);
+            RecordRelocation();
             data_.Swap(temp_data);
         }
         else {
-            t = new (data_ + size_) T(std::forward<N>(arg)...);
+            t = detail::ConstructAt(data_ + size_, std::forward<N>(arg)...);
         }
         ++size_;
         return *t;
     }
 
-    void PushBack(const T& value) {
+    ADVANCED_VECTOR_CONSTEXPR void PushBack(const T& value) {
         EmplaceBack(std::forward<const T&>(value));
     }
 
-    void PushBack(T&& value) {
+    ADVANCED_VECTOR_CONSTEXPR void PushBack(T&& value) {
         EmplaceBack(std::forward<T&&>(value));
     }
 
-    void PopBack() noexcept {
+    ADVANCED_VECTOR_CONSTEXPR void PopBack() noexcept {
+        const MutationScope scope(*this);
         if (size_ > 0) {
             std::destroy_at(data_.GetAddress() + size_ - 1);
             --size_;
         }
     }
 
+    static constexpr size_t kDefaultPrefetchDistance = 8;
+
+    // Передаёт fn элементы-указатели по порядку, заранее запрашивая в кэш объект, на который
+    // указывает элемент, стоящий на distance позиций дальше. Обход массива указателей на
+    // разбросанные по памяти объекты иначе ждёт промаха кэша на каждом элементе. Подходящее
+    // расстояние - примерно задержка памяти, делённая на время обработки одного элемента
+    template <typename Fn>
+    void ForEachPrefetched(Fn&& fn, size_t distance = kDefaultPrefetchDistance) {
+        VisitPrefetched(data_.GetAddress(), size_, fn, distance);
+    }
+
+    template <typename Fn>
+    void ForEachPrefetched(Fn&& fn, size_t distance = kDefaultPrefetchDistance) const {
+        VisitPrefetched(data_.GetAddress(), size_, fn, distance);
+    }
+
+    // Передаёт fn(first, count) подряд идущие участки по chunk_size элементов (последний
+    // может быть короче). Цикл внутри fn по непрерывному участку компилятор может
+    // векторизовать, а промежуточные данные участка помещаются в кэш
+    template <typename Fn>
+    void ForEachChunk(Fn&& fn, size_t chunk_size) {
+        VisitChunks(data_.GetAddress(), size_, fn, chunk_size);
+    }
 
+    template <typename Fn>
+    void ForEachChunk(Fn&& fn, size_t chunk_size) const {
+        VisitChunks(data_.GetAddress(), size_, fn, chunk_size);
+    }
 
-    size_t Size() const noexcept {
+    ADVANCED_VECTOR_CONSTEXPR size_t Size() const noexcept {
         return size_;
     }
 
-    size_t Capacity() const noexcept {
+    ADVANCED_VECTOR_CONSTEXPR size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    void Reserve(size_t new_capacity) {
+    ADVANCED_VECTOR_CONSTEXPR const Allocator& GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR void Reserve(size_t new_capacity) {
         if (new_capacity <= data_.Capacity()) {
             return;
         }
-        RawMemory<T> temp_data(new_capacity);
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, temp_data.GetAddress());
-        }
-        else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, temp_data.GetAddress());
+        const MutationScope scope(*this);
+        if (GrowInPlace(new_capacity)) {
+            return;
         }
-        std::destroy_n(data_.GetAddress(), size_);
+        Storage temp_data(new_capacity, data_.GetAllocator());
+        MoveOrCopy(data_.GetAddress(), size_, temp_data.GetAddress());
+        RecordRelocation();
         data_.Swap(temp_data);
     }
 
-    void Swap(Vector& other) noexcept {
+    ADVANCED_VECTOR_CONSTEXPR void Swap(BasicVector& other) noexcept(!kHasInlineBuffer || std::is_nothrow_move_constructible_v<T>) {
+        // Векторы с неравными аллокаторами, которые не передаются при обмене, обменивать нельзя
+        assert(AllocTraits::propagate_on_container_swap::value || GetAllocator() == other.GetAllocator());
+        // Элементы встроенного буфера переносятся в буфер другого вектора
+        const MutationScope scope(*this, std::max(size_, other.size_));
+        const MutationScope other_scope(other, std::max(size_, other.size_));
+        if constexpr (kHasInlineBuffer) {
+            if (data_.IsInline() || other.data_.IsInline()) {
+                // Элементы встроенного буфера нельзя передать обменом указателей, их приходится перемещать
+                BasicVector temp(std::move(other));
+                other.MoveFrom(*this);
+                MoveFrom(temp);
+                return;
+            }
+        }
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
     }
-    const T& operator[](size_t index) const noexcept {
-        return const_cast<Vector&>(*this)[index];
+    ADVANCED_VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
+        return const_cast<BasicVector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < size_);
+    ADVANCED_VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        ADVANCED_VECTOR_CHECK(index < size_, "index out of range");
         return data_[index];
     }
 
-    Vector& operator=(const Vector& rhs) {
+    ADVANCED_VECTOR_CONSTEXPR BasicVector& operator=(const BasicVector& rhs) {
         if (this != &rhs) {
+            const MutationScope scope(*this, rhs.size_);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // Текущую память может освободить только прежний аллокатор,
+                    // поэтому она освобождается до копирования элементов в память нового
+                    RecordRelease();
+                    std::destroy_n(data_.GetAddress(), size_);
+                    size_ = 0;
+                    Storage empty(rhs.GetAllocator());
+                    data_.Swap(empty);
+                }
+            }
             if (data_.Capacity() < rhs.size_) {
-                Vector rhs_copy(rhs);
-                Swap(rhs_copy);
+                // Достаточно нового буфера: элементы копируются в него, и только затем
+                // прежние элементы разрушаются
+                Storage temp_data(rhs.size_, data_.GetAllocator());
+                UninitializedCopyN(rhs.data_.GetAddress(), rhs.size_, temp_data.GetAddress());
+                RecordRelease();
+                std::destroy_n(data_.GetAddress(), size_);
+                data_.Swap(temp_data);
+                size_ = rhs.size_;
             }
             else {
                 size_t common_size = std::min(size_, rhs.size_);
-                std::copy_n(rhs.data_.GetAddress(), common_size, data_.GetAddress());
+                CopyN(rhs.data_.GetAddress(), common_size, data_.GetAddress());
 
                 if (rhs.size_ > size_) {
-                    std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
+                    UninitializedCopyN(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
                 }
                 else {
                     std::destroy_n(data_.GetAddress() + rhs.size_, size_ - rhs.size_);
@@ -293,14 +1227,322 @@ public:
         }
         return *this;
     }
-    Vector& operator=(Vector&& rhs) noexcept {
+    ADVANCED_VECTOR_CONSTEXPR BasicVector& operator=(BasicVector&& rhs) noexcept((AllocTraits::propagate_on_container_move_assignment::value
+                                              || AllocTraits::is_always_equal::value)
+                                             && (!kHasInlineBuffer || std::is_nothrow_move_constructible_v<T>)) {
         if (this != &rhs) {
-            Swap(rhs);
+            const MutationScope scope(*this, rhs.size_);
+            const MutationScope rhs_scope(rhs);
+            if (AllocTraits::propagate_on_container_move_assignment::value
+                || GetAllocator() == rhs.GetAllocator()) {
+                if constexpr (kHasInlineBuffer) {
+                    Resize(0);
+                    MoveFrom(rhs);
+                }
+                else {
+                    data_.Swap(rhs.data_);
+                    std::swap(size_, rhs.size_);
+                }
+            }
+            else {
+                // Память rhs принадлежит чужому аллокатору, поэтому элементы перемещаются по одному
+                Resize(0);
+                Reserve(rhs.size_);
+                detail::UninitializedMoveN(rhs.data_.GetAddress(), rhs.size_, data_.GetAddress());
+                size_ = rhs.size_;
+            }
         }
         return *this;
     }
 
 private:
+    // Источник элементов для InsertN: count копий одного значения
+    struct FillSource {
+        const T& value;
+
+        ADVANCED_VECTOR_CONSTEXPR void Construct(T* dest, size_t /*offset*/, size_t count) const {
+            detail::UninitializedFillN(dest, count, value);
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR void Assign(T* dest, size_t /*offset*/, size_t count) const {
+            std::fill_n(dest, count, value);
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR bool Aliases(const T* first, const T* last) const noexcept {
+            if (detail::IsConstantEvaluated()) {
+                // При компиляции указатели на разные объекты можно сравнивать только на равенство
+                return std::find_if(first, last, [this](const T& item) { return &item == &value; }) != last;
+            }
+            return std::less_equal<>{}(first, &value) && std::less<>{}(&value, last);
+        }
+    };
+
+    // Источник элементов для InsertN: диапазон, начинающийся с итератора first.
+    // Из непрерывного диапазона тривиально копируемых элементов копирование выполняется memcpy
+    template <typename ForwardIt>
+    struct RangeSource {
+        ForwardIt first;
+
+        ADVANCED_VECTOR_CONSTEXPR void Construct(T* dest, size_t offset, size_t count) const {
+            const auto from = std::next(first, static_cast<std::ptrdiff_t>(offset));
+            if constexpr (std::is_trivially_copyable_v<T> && (std::is_same_v<ForwardIt, T*> || std::is_same_v<ForwardIt, const T*>)) {
+                if (count != 0 && !detail::IsConstantEvaluated()) {
+                    std::memcpy(static_cast<void*>(dest), static_cast<const void*>(from), count * sizeof(T));
+                    return;
+                }
+            }
+            detail::UninitializedCopyN(from, count, dest);
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR void Assign(T* dest, size_t offset, size_t count) const {
+            std::copy_n(std::next(first, static_cast<std::ptrdiff_t>(offset)), count, dest);
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR bool Aliases(const T* /*first*/, const T* /*last*/) const noexcept {
+            return false;
+        }
+    };
+
+    // Вставляет перед pos count элементов из источника source
+    template <typename Source>
+    ADVANCED_VECTOR_CONSTEXPR iterator InsertN(const_iterator pos, size_t count, const Source& source) {
+        const size_t i = IndexOf(pos);
+        ADVANCED_VECTOR_CHECK(i <= size_, "Insert position out of range");
+        if (count == 0) {
+            return MakeIterator(i);
+        }
+        const MutationScope scope(*this, size_ + count);
+        if (size_ + count > Capacity()) {
+            const size_t new_capacity = NextCapacity(size_ + count);
+            if (source.Aliases(data_.GetAddress(), data_ + size_) || !GrowInPlace(new_capacity)) {
+                // Новые элементы создаются до переноса старых, поэтому источник может ссылаться на вектор
+                Storage temp(new_capacity, data_.GetAllocator());
+                source.Construct(temp + i, 0, count);
+                RelocateAroundGap(temp, i, count);
+                RecordRelocation();
+                data_.Swap(temp);
+                size_ += count;
+                return MakeIterator(i);
+            }
+        }
+        if constexpr (std::is_same_v<Source, FillSource>) {
+            if (source.Aliases(data_.GetAddress(), data_ + size_)) {
+                // Сдвиг хвоста испортил бы вставляемое значение, поэтому сначала делается его копия
+                const T value_copy(source.value);
+                return InsertN(pos, count, FillSource{ value_copy });
+            }
+        }
+
+        T* gap = data_ + i;
+        const size_t elems_after = size_ - i;
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            ShiftBytes(gap, elems_after, static_cast<std::ptrdiff_t>(count));
+            try {
+                source.Construct(gap, 0, count);
+            }
+            catch (...) {
+                ShiftBytes(gap + count, elems_after, -static_cast<std::ptrdiff_t>(count));
+                throw;
+            }
+            size_ += count;
+        }
+        else {
+            T* old_end = data_ + size_;
+            if (elems_after > count) {
+                detail::UninitializedMoveN(old_end - count, count, old_end);
+                size_ += count;
+                std::move_backward(gap, old_end - count, old_end);
+                source.Assign(gap, 0, count);
+            }
+            else {
+                source.Construct(old_end, elems_after, count - elems_after);
+                size_ += count - elems_after;
+                detail::UninitializedMoveN(gap, elems_after, gap + count);
+                size_ += elems_after;
+                source.Assign(gap, 0, elems_after);
+            }
+        }
+        return MakeIterator(i);
+    }
+
+    // Переносит элементы в новое хранилище temp, оставляя перед бывшим элементом pos
+    // промежуток из count уже созданных в temp элементов. Если перенос не удался,
+    // элементы промежутка разрушаются, а вектор остаётся прежним
+    ADVANCED_VECTOR_CONSTEXPR void RelocateAroundGap(Storage& temp, size_t pos, size_t count) {
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            MoveOrCopy(data_.GetAddress(), pos, temp.GetAddress());
+            MoveOrCopy(data_ + pos, size_ - pos, temp + (pos + count));
+        }
+        else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+            // Перенос не выбрасывает исключений, поэтому каждый элемент разрушается сразу
+            // после перемещения, пока он ещё в кэше
+            RelocateN(data_.GetAddress(), pos, temp.GetAddress());
+            RelocateN(data_ + pos, size_ - pos, temp + (pos + count));
+        }
+        else {
+            // Старые элементы разрушаются только после того, как обе части скопированы,
+            // иначе исключение при копировании хвоста оставило бы вектор с разрушенным началом
+            try {
+                UninitializedMoveOrCopy(data_.GetAddress(), pos, temp.GetAddress());
+            }
+            catch (...) {
+                std::destroy_n(temp + pos, count);
+                throw;
+            }
+
+            try {
+                UninitializedMoveOrCopy(data_ + pos, size_ - pos, temp + (pos + count));
+            }
+            catch (...) {
+                std::destroy_n(temp.GetAddress(), pos + count);
+                throw;
+            }
+            std::destroy_n(data_.GetAddress(), size_);
+        }
+    }
+
+    // Забирает элементы other в пустой вектор: буфер из кучи передаётся обменом вместе
+    // с аллокатором, а элементы встроенного буфера переносятся поштучно
+    ADVANCED_VECTOR_CONSTEXPR void MoveFrom(BasicVector& other) noexcept(!kHasInlineBuffer || std::is_nothrow_move_constructible_v<T>) {
+        assert(size_ == 0);
+        if constexpr (kHasInlineBuffer) {
+            if (other.data_.IsInline()) {
+                assert(Capacity() >= other.size_);
+                MoveOrCopy(other.data_.GetAddress(), other.size_, data_.GetAddress());
+                size_ = std::exchange(other.size_, 0);
+                return;
+            }
+        }
+        data_.Swap(other.data_);
+        std::swap(size_, other.size_);
+    }
+
+    template <typename Item, typename Fn>
+    static void VisitPrefetched(Item* items, size_t size, Fn& fn, size_t distance) {
+        const size_t ahead = std::min(distance, size);
+        for (size_t i = 0; i < ahead; ++i) {
+            detail::Prefetch(detail::PointeeAddress(items[i]));
+        }
+        // Основной цикл не проверяет выход за конец массива: последние ahead элементов
+        // уже запрошены и обходятся отдельно
+        for (size_t i = 0; i + ahead < size; ++i) {
+            detail::Prefetch(detail::PointeeAddress(items[i + ahead]));
+            fn(items[i]);
+        }
+        for (size_t i = size - ahead; i < size; ++i) {
+            fn(items[i]);
+        }
+    }
+
+    template <typename Item, typename Fn>
+    static void VisitChunks(Item* items, size_t size, Fn& fn, size_t chunk_size) {
+        assert(chunk_size > 0);
+        for (size_t offset = 0; offset < size; offset += chunk_size) {
+            fn(items + offset, std::min(chunk_size, size - offset));
+        }
+    }
+
+    // Границы изменяющей операции, которая обращается к элементам буфера до индекса reach.
+    // В защищённом режиме внешняя из вложенных операций снимает разметку с [Size(), reach),
+    // а по окончании размечает неиспользуемую вместимость заново и, если буфер сменился,
+    // увеличивает поколение итераторов. Разметка меняется только на участке между прежним
+    // и новым размером, поэтому PushBack остаётся амортизированно O(1). Иначе ничего не делает
+    class MutationScope {
+    public:
+        ADVANCED_VECTOR_CONSTEXPR explicit MutationScope(BasicVector& owner) noexcept
+            : MutationScope(owner, owner.size_) {
+        }
+
+        ADVANCED_VECTOR_CONSTEXPR MutationScope(BasicVector& owner, size_t reach) noexcept
+            : owner_(owner) {
+            if constexpr (kVectorHardened) {
+                if (owner_.hardened_.mutation_depth++ == 0) {
+                    buffer_ = owner_.data_.GetAddress();
+                    capacity_ = owner_.Capacity();
+                    reach_ = std::min(std::max(reach, owner_.size_), capacity_);
+                    owner_.Annotate(owner_.size_, reach_);
+                }
+            }
+            else {
+                static_cast<void>(reach);
+            }
+        }
+
+        MutationScope(const MutationScope&) = delete;
+        MutationScope& operator=(const MutationScope&) = delete;
+
+        ADVANCED_VECTOR_CONSTEXPR ~MutationScope() {
+            if constexpr (kVectorHardened) {
+                if (--owner_.hardened_.mutation_depth == 0) {
+                    // При компиляции прежний буфер мог быть освобождён, и его адрес нельзя сравнивать
+                    const bool moved = detail::IsConstantEvaluated() || owner_.data_.GetAddress() != buffer_;
+                    if (moved) {
+                        ++owner_.hardened_.generation;
+                    }
+                    if (moved || owner_.Capacity() != capacity_) {
+                        // Разметка нового или расширенного буфера неизвестна: он размечается целиком
+                        owner_.Annotate(0, owner_.Capacity());
+                        owner_.Annotate(owner_.Capacity(), owner_.size_);
+                    }
+                    else {
+                        owner_.Annotate(reach_, owner_.size_);
+                    }
+                }
+            }
+        }
+
+    private:
+        BasicVector& owner_;
+        const T* buffer_ = nullptr;
+        size_t capacity_ = 0;
+        size_t reach_ = 0;
+    };
+
+    // Сообщает AddressSanitizer, что из буфера в куче доступны первые new_mid элементов
+    // вместо прежних old_mid
+    ADVANCED_VECTOR_CONSTEXPR void Annotate(size_t old_mid, size_t new_mid) const noexcept {
+        if constexpr (kVectorHardened) {
+            if (!detail::IsConstantEvaluated() && !IsUsingInlineBuffer() && Capacity() != 0 && old_mid != new_mid) {
+                const T* first = data_.GetAddress();
+                detail::AnnotateContiguousContainer(first, first + Capacity(), first + old_mid, first + new_mid);
+            }
+        }
+        else {
+            static_cast<void>(old_mid);
+            static_cast<void>(new_mid);
+        }
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR iterator MakeIterator(size_t index) noexcept {
+        if constexpr (kVectorHardened) {
+            return iterator(this, data_.GetAddress() + index);
+        }
+        else {
+            return data_.GetAddress() + index;
+        }
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR const_iterator MakeIterator(size_t index) const noexcept {
+        if constexpr (kVectorHardened) {
+            return const_iterator(this, data_.GetAddress() + index);
+        }
+        else {
+            return data_.GetAddress() + index;
+        }
+    }
+
+    // Номер элемента, на который указывает pos. В защищённом режиме проверяет, что итератор
+    // получен от этого вектора и с тех пор буфер не сменился
+    ADVANCED_VECTOR_CONSTEXPR size_t IndexOf(const_iterator pos) const noexcept {
+        if constexpr (kVectorHardened) {
+            ADVANCED_VECTOR_CHECK(pos.owner_ == this && pos.IsValid(), "iterator does not belong to the vector or was invalidated");
+            return static_cast<size_t>(pos.ptr_ - data_.GetAddress());
+        }
+        else {
+            return static_cast<size_t>(pos - data_.GetAddress());
+        }
+    }
+
     // Вызывает деструкторы n объектов массива по адресу buf
     static void DestroyN(T* buf, size_t n) noexcept {
         for (size_t i = 0; i != n; ++i) {
@@ -318,17 +1560,203 @@ private:
         buf->~T();
     }
 
-    void MoveOrCopy(T* from_vec, size_t size, T* target_vec) {
+    // Освобождает память пустого вектора
+    ADVANCED_VECTOR_CONSTEXPR void ReleaseMemory() noexcept {
+        assert(size_ == 0);
+        RecordRelease();
+        Storage empty(data_.GetAllocator());
+        data_.Swap(empty);
+    }
+
+    // Учитывает в статистике перенос элементов из текущего буфера в новый, после которого
+    // текущий буфер освобождается
+    ADVANCED_VECTOR_CONSTEXPR void RecordRelocation() const noexcept {
+        if (Capacity() != 0) {
+            Stats::OnRelocate(size_ * sizeof(T));
+        }
+        RecordRelease();
+    }
+
+    // Учитывает в статистике освобождение текущего буфера в куче, в котором ещё лежат size_ элементов
+    ADVANCED_VECTOR_CONSTEXPR void RecordRelease() const noexcept {
+        if constexpr (kVectorStatsEnabled) {
+            if (!IsUsingInlineBuffer() && Capacity() != 0) {
+                Stats::OnRelease((Capacity() - size_) * sizeof(T));
+            }
+        }
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR bool IsUsingInlineBuffer() const noexcept {
+        if constexpr (kHasInlineBuffer) {
+            return data_.IsInline();
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Вместимость, до которой нужно вырасти, чтобы вместить required элементов
+    ADVANCED_VECTOR_CONSTEXPR size_t NextCapacity(size_t required) const noexcept {
+        return GrowthPolicy::NextCapacity(Capacity(), required, sizeof(T));
+    }
+
+    static constexpr bool kHasInlineBuffer = detail::HasInlineBuffer<Storage>::value;
+    static constexpr bool kCanGrowInPlace = Storage::kCanExpand
+        || (kIsTriviallyRelocatable<T> && Storage::kCanReallocate);
+
+    // Проверяет, лежит ли какой-либо из аргументов в памяти вектора
+    template <typename... Args>
+    ADVANCED_VECTOR_CONSTEXPR bool ArgumentsAlias(const Args&... args) const noexcept {
+        if (detail::IsConstantEvaluated()) {
+            // При компиляции адреса нельзя сравнить, и считается, что непустые аргументы ссылаются на вектор
+            return sizeof...(Args) != 0;
+        }
+        const auto* first = reinterpret_cast<const char*>(data_.GetAddress());
+        const auto* last = reinterpret_cast<const char*>(data_.GetAddress() + Capacity());
+        const auto points_inside = [first, last](const void* address) {
+            return std::less_equal<>{}(first, address) && std::less<>{}(address, last);
+        };
+        return (points_inside(std::addressof(args)) || ...);
+    }
+
+    // Сдвигает элементы [pos, size_) тривиально перемещаемого T одним memmove на позицию
+    // вправо и создаёт новый элемент на освободившемся месте. Если конструктор выбросил
+    // исключение, хвост возвращается обратно
+    template <typename... Args>
+    ADVANCED_VECTOR_CONSTEXPR void EmplaceInGap(size_t pos, Args&&... args) {
+        const size_t tail_size = size_ - pos;
+        ShiftBytes(data_ + pos, tail_size, 1);
+        try {
+            detail::ConstructAt(data_ + pos, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            ShiftBytes(data_ + (pos + 1), tail_size, -1);
+            throw;
+        }
+    }
+
+    // Сдвигает элементы [pos, size_) на одну позицию вправо: последний элемент перемещается
+    // в сырую память за концом, остальные - присваиванием. Элемент pos остаётся перемещённым
+    ADVANCED_VECTOR_CONSTEXPR void ShiftTailRight(size_t pos) {
+        detail::ConstructAt(data_ + size_, std::move(data_[size_ - 1]));
+        std::move_backward(data_ + pos, data_ + (size_ - 1), data_ + size_);
+    }
+
+    // Пытается увеличить вместимость до new_capacity без выделения нового буфера:
+    // сначала расширением на месте, а для тривиально перемещаемых T - ещё и через reallocate аллокатора.
+    // Если какой-либо из аргументов args ссылается на память вектора, рост не выполняется:
+    // аргумент должен остаться действительным до конструирования нового элемента
+    template <typename... Args>
+    ADVANCED_VECTOR_CONSTEXPR bool GrowInPlace(size_t new_capacity, const Args&... args) noexcept {
+        if constexpr (kCanGrowInPlace) {
+            if (ArgumentsAlias(args...)) {
+                return false;
+            }
+            if (data_.TryExpand(new_capacity)) {
+                return true;
+            }
+            if constexpr (kIsTriviallyRelocatable<T>) {
+                return data_.TryReallocate(new_capacity);
+            }
+        }
+        return false;
+    }
+
+    // Создаёт в сырой памяти target_vec копии size элементов from_vec, перемещая их,
+    // если перемещение не выбрасывает исключений. Исходные элементы не разрушаются
+    static ADVANCED_VECTOR_CONSTEXPR void UninitializedMoveOrCopy(T* from_vec, size_t size, T* target_vec) {
         if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(from_vec, size, target_vec);
+            detail::UninitializedMoveN(from_vec, size, target_vec);
+        }
+        else {
+            detail::UninitializedCopyN(from_vec, size, target_vec);
+        }
+    }
+
+    // Копирует size элементов в сырую память target_vec, для тривиально копируемых T - одним memcpy
+    static ADVANCED_VECTOR_CONSTEXPR void UninitializedCopyN(const T* from_vec, size_t size, T* target_vec) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (size != 0 && !detail::IsConstantEvaluated()) {
+                std::memcpy(static_cast<void*>(target_vec), static_cast<const void*>(from_vec), size * sizeof(T));
+                return;
+            }
+        }
+        detail::UninitializedCopyN(from_vec, size, target_vec);
+    }
+
+    // Присваивает size элементам target_vec значения from_vec, для тривиально копируемых T - одним memcpy
+    static ADVANCED_VECTOR_CONSTEXPR void CopyN(const T* from_vec, size_t size, T* target_vec) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (size != 0 && !detail::IsConstantEvaluated()) {
+                std::memcpy(static_cast<void*>(target_vec), static_cast<const void*>(from_vec), size * sizeof(T));
+                return;
+            }
+        }
+        std::copy_n(from_vec, size, target_vec);
+    }
+
+    // Перемещает size элементов в сырую память target_vec, разрушая каждый исходный
+    // элемент сразу после перемещения
+    static ADVANCED_VECTOR_CONSTEXPR void RelocateN(T* from_vec, size_t size, T* target_vec) noexcept {
+        for (size_t i = 0; i < size; ++i) {
+            detail::ConstructAt(target_vec + i, std::move(from_vec[i]));
+            std::destroy_at(from_vec + i);
+        }
+    }
+
+    // Сдвигает size тривиально перемещаемых элементов, начиная с first, на offset позиций
+    // одним memmove. Место, куда они сдвигаются, должно быть сырой памятью. При вычислении
+    // на этапе компиляции memmove недоступен, и элементы переносятся поштучно, начиная
+    // с ближнего к месту назначения края
+    static ADVANCED_VECTOR_CONSTEXPR void ShiftBytes(T* first, size_t size, std::ptrdiff_t offset) noexcept {
+        if (detail::IsConstantEvaluated()) {
+            for (size_t i = 0; i < size; ++i) {
+                T* item = first + (offset < 0 ? i : size - 1 - i);
+                detail::ConstructAt(item + offset, std::move(*item));
+                std::destroy_at(item);
+            }
+            return;
+        }
+        if (size != 0) {
+            std::memmove(static_cast<void*>(first + offset), static_cast<const void*>(first), size * sizeof(T));
+        }
+    }
+
+    // Переносит size элементов из from_vec в сырую память target_vec. После вызова
+    // память from_vec снова считается сырой. Для тривиально перемещаемых типов
+    // перенос выполняется одним memcpy без вызова конструкторов и деструкторов
+    static ADVANCED_VECTOR_CONSTEXPR void MoveOrCopy(T* from_vec, size_t size, T* target_vec) {
+        if constexpr (kIsTriviallyRelocatable<T>) {
+            if (detail::IsConstantEvaluated()) {
+                RelocateN(from_vec, size, target_vec);
+            }
+            else if (size != 0) {
+                std::memcpy(static_cast<void*>(target_vec), static_cast<const void*>(from_vec), size * sizeof(T));
+            }
         }
         else {
-            std::uninitialized_copy_n(from_vec, size, target_vec);
+            UninitializedMoveOrCopy(from_vec, size, target_vec);
+            std::destroy_n(from_vec, size);
         }
-        std::destroy_n(from_vec, size);
     }
 
 
-    RawMemory<T> data_;
+    Storage data_;
     size_t size_ = 0;
-};
\ No newline at end of file
+    [[no_unique_address]] detail::HardenedState<BasicVector> hardened_;
+};
+
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+using Vector = BasicVector<T, RawMemory<T, Allocator>, GrowthPolicy>;
+
+// Вектор, который хранит до N элементов во встроенном буфере и обращается к куче
+// только при превышении этой вместимости
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+using SmallVector = BasicVector<T, InlineMemory<T, N, Allocator>, GrowthPolicy>;
+
+// Вектор вместимостью не больше N элементов, которые хранятся во встроенном буфере.
+// Память из кучи не выделяется никогда (кроме вычисления на этапе компиляции, см. FixedMemory):
+// добавление в заполненный вектор, Reserve и Resize сверх N выбрасывают std::length_error,
+// не меняя вектор
+template <typename T, size_t N, typename GrowthPolicy = DoublingGrowth>
+using StaticVector = BasicVector<T, FixedMemory<T, N>, GrowthPolicy>;
@@ -0,0 +1,261 @@
+#pragma once
+#include "constexpr_support.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+
+// Статистика выделений памяти и перевыделений векторов. Включается макросом ADVANCED_VECTOR_STATS,
+// заданным до подключения vector.h (например, -DADVANCED_VECTOR_STATS). Без него все точки
+// учёта пусты и не влияют ни на размер векторов, ни на генерируемый код.
+//
+// Счётчики собираются по тегам. По умолчанию тегом служит тип элемента, а векторы
+// с TaggedAllocator<T, Tag> учитываются под тегом Tag. Накопленные значения можно
+// выгрузить в систему мониторинга через ForEachVectorStats
+#ifdef ADVANCED_VECTOR_STATS
+inline constexpr bool kVectorStatsEnabled = true;
+#else
+inline constexpr bool kVectorStatsEnabled = false;
+#endif
+
+struct VectorStatsSnapshot {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes_allocated = 0;
+    // Перевыделения буфера с переносом элементов, а также рост и сжатие без переноса (средствами аллокатора)
+    uint64_t reallocations = 0;
+    uint64_t in_place_growths = 0;
+    uint64_t in_place_shrinks = 0;
+    uint64_t bytes_relocated = 0;
+    // Суммарная вместимость живых буферов и её максимум за всё время
+    uint64_t live_capacity_bytes = 0;
+    uint64_t peak_capacity_bytes = 0;
+    // Неиспользованная вместимость (capacity - size) буферов в момент их освобождения векторами:
+    // при разрушении, перевыделении, ShrinkToFit, Clear(true), присваивании и Adopt
+    uint64_t wasted_capacity_bytes = 0;
+};
+
+class VectorStats {
+public:
+    explicit VectorStats(const char* name) noexcept
+        : name_(name) {
+        // Регистрация без блокировок: статистика добавляется в голову односвязного списка
+        next_ = Head().load(std::memory_order_relaxed);
+        while (!Head().compare_exchange_weak(next_, this, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    VectorStats(const VectorStats&) = delete;
+    VectorStats& operator=(const VectorStats&) = delete;
+
+    void OnAllocate(size_t bytes) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+        AddLiveCapacity(bytes);
+    }
+
+    void OnDeallocate(size_t bytes) noexcept {
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        live_capacity_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void OnGrowInPlace(size_t old_bytes, size_t new_bytes) noexcept {
+        in_place_growths_.fetch_add(1, std::memory_order_relaxed);
+        AddLiveCapacity(new_bytes - old_bytes);
+    }
+
+    void OnShrinkInPlace(size_t old_bytes, size_t new_bytes) noexcept {
+        in_place_shrinks_.fetch_add(1, std::memory_order_relaxed);
+        live_capacity_bytes_.fetch_sub(old_bytes - new_bytes, std::memory_order_relaxed);
+    }
+
+    void OnRelocate(size_t bytes) noexcept {
+        reallocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_relocated_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void OnRelease(size_t wasted_bytes) noexcept {
+        wasted_capacity_bytes_.fetch_add(wasted_bytes, std::memory_order_relaxed);
+    }
+
+    const char* GetName() const noexcept {
+        return name_;
+    }
+
+    VectorStatsSnapshot GetSnapshot() const noexcept {
+        VectorStatsSnapshot snapshot;
+        snapshot.allocations = allocations_.load(std::memory_order_relaxed);
+        snapshot.deallocations = deallocations_.load(std::memory_order_relaxed);
+        snapshot.bytes_allocated = bytes_allocated_.load(std::memory_order_relaxed);
+        snapshot.reallocations = reallocations_.load(std::memory_order_relaxed);
+        snapshot.in_place_growths = in_place_growths_.load(std::memory_order_relaxed);
+        snapshot.in_place_shrinks = in_place_shrinks_.load(std::memory_order_relaxed);
+        snapshot.bytes_relocated = bytes_relocated_.load(std::memory_order_relaxed);
+        snapshot.live_capacity_bytes = live_capacity_bytes_.load(std::memory_order_relaxed);
+        snapshot.peak_capacity_bytes = peak_capacity_bytes_.load(std::memory_order_relaxed);
+        snapshot.wasted_capacity_bytes = wasted_capacity_bytes_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    // Сбрасывает накопительные счётчики. Текущая живая вместимость сохраняется и становится новым пиком
+    void Reset() noexcept {
+        allocations_.store(0, std::memory_order_relaxed);
+        deallocations_.store(0, std::memory_order_relaxed);
+        bytes_allocated_.store(0, std::memory_order_relaxed);
+        reallocations_.store(0, std::memory_order_relaxed);
+        in_place_growths_.store(0, std::memory_order_relaxed);
+        in_place_shrinks_.store(0, std::memory_order_relaxed);
+        bytes_relocated_.store(0, std::memory_order_relaxed);
+        wasted_capacity_bytes_.store(0, std::memory_order_relaxed);
+        peak_capacity_bytes_.store(live_capacity_bytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    const VectorStats* GetNext() const noexcept {
+        return next_;
+    }
+
+    static const VectorStats* GetFirst() noexcept {
+        return Head().load(std::memory_order_acquire);
+    }
+
+private:
+    static std::atomic<VectorStats*>& Head() noexcept {
+        static std::atomic<VectorStats*> head{ nullptr };
+        return head;
+    }
+
+    void AddLiveCapacity(size_t bytes) noexcept {
+        const uint64_t live = live_capacity_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        uint64_t peak = peak_capacity_bytes_.load(std::memory_order_relaxed);
+        while (peak < live && !peak_capacity_bytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    const char* name_;
+    VectorStats* next_ = nullptr;
+    std::atomic<uint64_t> allocations_{ 0 };
+    std::atomic<uint64_t> deallocations_{ 0 };
+    std::atomic<uint64_t> bytes_allocated_{ 0 };
+    std::atomic<uint64_t> reallocations_{ 0 };
+    std::atomic<uint64_t> in_place_growths_{ 0 };
+    std::atomic<uint64_t> in_place_shrinks_{ 0 };
+    std::atomic<uint64_t> bytes_relocated_{ 0 };
+    std::atomic<uint64_t> live_capacity_bytes_{ 0 };
+    std::atomic<uint64_t> peak_capacity_bytes_{ 0 };
+    std::atomic<uint64_t> wasted_capacity_bytes_{ 0 };
+};
+
+// Имя, под которым статистика тега Tag попадает в выгрузку. Специализация позволяет задать
+// читаемое имя вместо имени типа, которое возвращает typeid
+template <typename Tag>
+struct VectorStatsName {
+    static const char* Get() noexcept {
+        return typeid(Tag).name();
+    }
+};
+
+template <typename Tag>
+VectorStats& GetVectorStats() noexcept {
+    static VectorStats stats(VectorStatsName<Tag>::Get());
+    return stats;
+}
+
+// Вызывает fn(name, snapshot) для каждого тега, по которому уже велась статистика
+template <typename Fn>
+void ForEachVectorStats(Fn&& fn) {
+    for (const VectorStats* stats = VectorStats::GetFirst(); stats != nullptr; stats = stats->GetNext()) {
+        fn(stats->GetName(), stats->GetSnapshot());
+    }
+}
+
+// Аллокатор Base, векторы с которым учитываются в статистике под тегом Tag
+template <typename T, typename Tag, typename Base = std::allocator<T>>
+class TaggedAllocator : public Base {
+public:
+    using stats_tag = Tag;
+
+    template <typename U>
+    struct rebind {
+        using other = TaggedAllocator<U, Tag, typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+    };
+
+    using Base::Base;
+
+    TaggedAllocator() = default;
+
+    TaggedAllocator(const Base& base)  // NOLINT(google-explicit-constructor)
+        : Base(base) {
+    }
+};
+
+namespace detail {
+
+template <typename Allocator, typename = void>
+struct StatsTagOf {
+    using Type = typename Allocator::value_type;
+};
+
+template <typename Allocator>
+struct StatsTagOf<Allocator, std::void_t<typename Allocator::stats_tag>> {
+    using Type = typename Allocator::stats_tag;
+};
+
+// Точки учёта, которые вызывают контейнеры. Без ADVANCED_VECTOR_STATS они ничего не делают,
+// а при вычислении на этапе компиляции не учитываются
+template <typename Allocator>
+struct StatsHooks {
+    using Tag = typename StatsTagOf<Allocator>::Type;
+
+    static ADVANCED_VECTOR_CONSTEXPR void OnAllocate(size_t bytes) noexcept {
+        if constexpr (kVectorStatsEnabled) {
+            if (!IsConstantEvaluated()) {
+                GetVectorStats<Tag>().OnAllocate(bytes);
+            }
+        }
+    }
+
+    static ADVANCED_VECTOR_CONSTEXPR void OnDeallocate(size_t bytes) noexcept {
+        if constexpr (kVectorStatsEnabled) {
+            if (!IsConstantEvaluated()) {
+                GetVectorStats<Tag>().OnDeallocate(bytes);
+            }
+        }
+    }
+
+    static ADVANCED_VECTOR_CONSTEXPR void OnGrowInPlace(size_t old_bytes, size_t new_bytes) noexcept {
+        if constexpr (kVectorStatsEnabled) {
+            if (!IsConstantEvaluated()) {
+                GetVectorStats<Tag>().OnGrowInPlace(old_bytes, new_bytes);
+            }
+        }
+    }
+
+    static ADVANCED_VECTOR_CONSTEXPR void OnShrinkInPlace(size_t old_bytes, size_t new_bytes) noexcept {
+        if constexpr (kVectorStatsEnabled) {
+            if (!IsConstantEvaluated()) {
+                GetVectorStats<Tag>().OnShrinkInPlace(old_bytes, new_bytes);
+            }
+        }
+    }
+
+    static ADVANCED_VECTOR_CONSTEXPR void OnRelocate(size_t bytes) noexcept {
+        if constexpr (kVectorStatsEnabled) {
+            if (!IsConstantEvaluated()) {
+                GetVectorStats<Tag>().OnRelocate(bytes);
+            }
+        }
+    }
+
+    static ADVANCED_VECTOR_CONSTEXPR void OnRelease(size_t wasted_bytes) noexcept {
+        if constexpr (kVectorStatsEnabled) {
+            if (!IsConstantEvaluated()) {
+                GetVectorStats<Tag>().OnRelease(wasted_bytes);
+            }
+        }
+    }
+};
+
+}  // namespace detail